@@ -23,6 +23,9 @@
 #ifndef PROJECT_INCLUDES_XMATH_H
 #define PROJECT_INCLUDES_XMATH_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 // #ifndef PROJECT_INCLUDES_LIBCX_TYPES_H
 // #include "types.h"
 // #endif
@@ -63,93 +66,461 @@ int __attribute_const abs(int x);
  * Greatest Common Divisor
  *
  * This function computes the greatest common divisor of two
- * integers using a simple implementation of the Euclidean
- * algorithm that does not rely on division operations. I
- * have not performed a comparative profile of this method
- * versus one using division operations, but my hunch is
- * that this method is faster. As I said, however, this
- * hunch is based on zero actual information.
+ * integers using Stein's binary algorithm, which replaces
+ * the divisions of the Euclidean algorithm with shifts and
+ * subtractions, and takes at most as many steps as there
+ * are bits in both numbers together.
  *
  * @param[in] a First factor
  * @param[in] b Second factor
  *
  * @returns The greatest common divisor of a and b.
  *
- * @note In order for this simpler subtraction-based
- * algorithm to work, both numbers must be greater than zero
- * (obviously), as otherwise the algorithm would never
- * terminate.
+ * @note The result is never negative, and is zero only if
+ * both a and b are zero. The greatest common divisor of the
+ * most negative int and either zero or itself is not
+ * representable, and wraps around to the most negative int.
  *
  * @todo Write man page for this function.
  *
  */
 int __attribute_const gcd(int a, int b);
 
+/*
+ * Greatest Common Divisor (64-bit)
+ *
+ * @see gcd()
+ *
+ */
+int64_t __attribute_const gcd64(int64_t a, int64_t b);
+
+#ifdef __SIZEOF_INT128__
+
+/*
+ * Greatest Common Divisor (128-bit)
+ *
+ * @see gcd()
+ *
+ */
+unsigned __int128 __attribute_const gcd128(unsigned __int128 a, unsigned __int128 b);
+
+#endif /** __SIZEOF_INT128__ */
+
+/*
+ * Greatest Common Divisor of an Array
+ *
+ * This function computes the greatest common divisor of
+ * every number in the array, stopping early once it reaches
+ * one. Several independent running divisors are kept over
+ * interleaved elements of the array, so that their steps
+ * overlap.
+ *
+ * @param[in] values The numbers to take the divisor of.
+ * @param[in] count The number of values.
+ *
+ * @returns The greatest common divisor of the values, or
+ * zero if count is zero.
+ *
+ */
+int64_t
+__attribute__((pure, nonnull(1)))
+gcd_array(const int64_t* values, size_t count);
+
+/*
+ * Pairwise Greatest Common Divisors
+ *
+ * This function computes the greatest common divisor of
+ * a[i] and b[i] for every i, eight pairs at a time in the
+ * lanes of a vector register where the host supports it.
+ *
+ * @param[in] a The first factors.
+ * @param[in] b The second factors.
+ * @param[out] results The divisors, one per pair.
+ * @param[in] count The number of pairs.
+ *
+ */
+void
+__attribute__((nonnull(1,2,3)))
+gcd_batch(const int64_t* a, const int64_t* b, int64_t* results, size_t count);
+
 /*
  * Least Common Multiple
  *
  * This function returns the least common multiple of the
- * integers a and b by leveraging the Greatest Common
- * Denominator function defined within this same module.
+ * integers a and b, computed as a / gcd(a, b) * b so that
+ * no intermediate result is larger than the final one.
  *
  * @param[in] a First factor.
  * @param[in] b Second factor.
  *
- * @returns The smallest integer divisible by both a and b.
- *
- * @remark The requirement that both a and b be non-negative
- * integers applies in this function just as it does in the
- * gcd() function, since it is implicitly used in the final
- * calculation.
+ * @returns The smallest nonnegative integer divisible by
+ * both a and b, which is zero if either of them is zero.
+ * If that multiple is not representable, the function
+ * returns zero and sets errno to ERANGE.
  *
  * @todo Write man page for this function.
  *
  */
-int __attribute_const lcm(int a, int b);
+int lcm(int a, int b);
+
+/*
+ * Least Common Multiple (64-bit)
+ *
+ * @see lcm()
+ *
+ */
+int64_t lcm64(int64_t a, int64_t b);
+
+#ifdef __SIZEOF_INT128__
+
+/*
+ * Least Common Multiple (128-bit)
+ *
+ * @see lcm()
+ *
+ */
+unsigned __int128 lcm128(unsigned __int128 a, unsigned __int128 b);
+
+#endif /** __SIZEOF_INT128__ */
+
+/*
+ * Least Common Multiple of an Array
+ *
+ * This function computes the least common multiple of every
+ * number in the array, such as the hyperperiod of a set of
+ * periodic tasks. It stops multiplying as soon as the
+ * running multiple overflows, and large arrays are split
+ * between one thread per processor.
+ *
+ * @param[in] values The numbers to take the multiple of.
+ * @param[in] count The number of values.
+ *
+ * @returns The least common multiple of the values, which
+ * is one if count is zero and zero if any value is zero.
+ * If that multiple is not representable, the function
+ * returns zero and sets errno to ERANGE.
+ *
+ */
+int64_t
+__attribute__((nonnull(1)))
+lcm_array(const int64_t* values, size_t count);
 
 /*
  * Is Prime
  *
- * This function checks whether a given number is prime by
- * brute-force, attempting to divide the given number \f$n\f$ by
- * every number \f$n-1\f$.
+ * This function checks whether a given number is prime.
+ * The number is first divided by the smallest primes, which
+ * settles most composites, and then put through the
+ * Miller-Rabin test with a fixed set of seven bases, which
+ * is known to admit no strong pseudoprime below 2^64, so
+ * the answer is exact for every input.
  *
  * @param[in] n The number to test for primality.
  *
  * @returns A boolean value which is true if \f$n\f$ is prime.
  *
- * @note As is customary in mathematics, \f$1\f$ is
- * considered prime.
+ * @note Neither \f$0\f$ nor \f$1\f$ is prime.
  *
  * @todo Write man page for this function.
  *
  */
-bool_t __attribute_const is_prime(int n);
+bool_t __attribute_const is_prime(uint64_t n);
+
+/*
+ * Is Prime (Array)
+ *
+ * This function tests every number in the array for
+ * primality, spreading large arrays over one thread per
+ * processor.
+ *
+ * @param[in] values The numbers to test for primality.
+ * @param[in] count The number of values.
+ * @param[out] results Whether each value is prime.
+ *
+ */
+void
+__attribute__((nonnull(1,3)))
+is_prime_array(const uint64_t* values, size_t count, bool_t* results);
+
+/*
+ * Prime Callback
+ *
+ * The type of the function for_each_prime() reports each
+ * prime to, along with the context it was given. Returning
+ * a nonzero value stops the enumeration.
+ *
+ */
+typedef int (*prime_callback_t)(uint64_t prime, void* context);
+
+/*
+ * Prime Iterator
+ *
+ * An opaque handle on an enumeration of the primes in a
+ * range, in increasing order.
+ *
+ */
+typedef struct prime_iterator prime_iterator_t;
+
+/*
+ * Create Prime Iterator
+ *
+ * This function prepares the enumeration of the primes p
+ * with low <= p <= high. The range is sieved with a
+ * segmented sieve of Eratosthenes over a wheel of
+ * circumference 30, one bit per number coprime to 30, a
+ * block of consecutive segments per thread at a time, so
+ * the memory needed grows only with the square root of
+ * high, about a hundred kilobytes of sieving primes for
+ * ranges up to 10^11, plus a block per processor.
+ *
+ * @param[in] low The smallest number of the range.
+ * @param[in] high The largest number of the range.
+ *
+ * @returns Pointer to the iterator, which must be released
+ * using free_prime_iterator().
+ *
+ */
+prime_iterator_t* create_prime_iterator(uint64_t low, uint64_t high);
+
+/*
+ * Get Next Prime
+ *
+ * @param[in,out] iterator The iterator.
+ * @param[out] prime The next prime of the range.
+ *
+ * @returns True if there was another prime in the range,
+ * or false once the range is exhausted.
+ *
+ */
+bool_t
+__attribute__((nonnull(1,2)))
+get_next_prime(prime_iterator_t* iterator, uint64_t* prime);
+
+/*
+ * Free Prime Iterator
+ *
+ * @param[in] iterator The iterator to free. May be NULL.
+ *
+ */
+void free_prime_iterator(prime_iterator_t* iterator);
+
+/*
+ * For Each Prime
+ *
+ * This function calls the callback with every prime p with
+ * low <= p <= high, in increasing order, from the calling
+ * thread, until the callback returns a nonzero value.
+ *
+ * @param[in] low The smallest number of the range.
+ * @param[in] high The largest number of the range.
+ * @param[in] callback The function to report primes to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns The number of primes reported to the callback.
+ *
+ */
+uint64_t
+__attribute__((nonnull(3)))
+for_each_prime(uint64_t low, uint64_t high, prime_callback_t callback, void* context);
+
+/*
+ * Prime Count
+ *
+ * This function counts the primes p with low <= p <= high,
+ * sieving blocks of the range on one thread per processor.
+ *
+ * @param[in] low The smallest number of the range.
+ * @param[in] high The largest number of the range.
+ *
+ * @returns The number of primes in the range.
+ *
+ */
+uint64_t prime_count(uint64_t low, uint64_t high);
+
+/*
+ * Nth Prime
+ *
+ * @param[in] n The index of the prime, starting from 1.
+ *
+ * @returns The nth prime, or zero if n is zero or the nth
+ * prime is not representable.
+ *
+ */
+uint64_t nth_prime(uint64_t n);
+
+/*
+ * Montgomery Context
+ *
+ * The constants of Montgomery arithmetic modulo an odd
+ * number n with R = 2^64: the inverse of n modulo R, and R
+ * and R^2 modulo n. Numbers in Montgomery form are stored
+ * as aR mod n, always reduced below n. Computing these
+ * takes a division of a 128-bit number, so a context is
+ * worth preparing once and reusing for every exponentiation
+ * modulo the same number.
+ *
+ */
+typedef struct {
+    uint64_t modulus;
+    uint64_t inverse;
+    uint64_t one;
+    uint64_t square;
+} montgomery_context_t;
+
+/*
+ * Initialize Montgomery Context
+ *
+ * @param[out] context The context to initialize.
+ * @param[in] modulus The modulus, which must be odd.
+ *
+ * @returns True if the context was initialized, or false
+ * if the modulus is even, which Montgomery arithmetic does
+ * not support.
+ *
+ */
+bool_t
+__attribute__((nonnull(1)))
+initialize_montgomery_context(montgomery_context_t* context, uint64_t modulus);
 
 /*
  * Modular Exponentiation
  *
- * This function uses the binary representation of \f$b\f$
- * to efficiently perform exponentiation. The method relies
- * on repeated squaring, as described by Cormen, et. al., in
- * <I>Introduction to Algorithms</I>. The result of this
- * function is equal to the following equation.
- * \f[d = a^b \text{mod }d\f]
+ * This function computes a^b mod n by left-to-right
+ * sliding-window exponentiation, which scans the bits of
+ * the exponent from the most significant down, squaring for
+ * every bit and multiplying by a precomputed odd power of
+ * the base for every window of up to three bits ending in a
+ * set bit, so it takes about one multiplication for every
+ * four bits of the exponent rather than one for every set
+ * bit. The products are reduced by Montgomery's method for
+ * odd moduli, which replaces the division by the modulus
+ * with two multiplications, and by 128-bit division for
+ * even ones.
  *
+ * @param[in] a Number to raise to a power.
+ * @param[in] b The power to raise \f$a\f$ to.
+ * @param[in] n The modulus to reduce \f$a^b\f$ by.
+ *
+ * @returns \f$a^b \bmod n\f$, or zero if n is zero.
+ *
+ * @cite montgomery_modular_1985
+ *
+ * @todo Write man page for this function.
  *
+ */
+uint64_t __attribute_const modular_exponentiation(uint64_t a, uint64_t b, uint64_t n);
+
+/*
+ * Modular Exponentiation (Montgomery Context)
+ *
+ * @param[in] context The modulus.
  * @param[in] a Number to raise to a power.
  * @param[in] b The power to raise \f$a\f$ to.
- * @param[in] d The modulus to reduce \f$a^b\f$ by.
  *
- * @returns The result of the above equation.
+ * @returns \f$a^b \bmod n\f$.
+ *
+ * @see modular_exponentiation()
+ *
+ */
+uint64_t
+__attribute__((pure, nonnull(1)))
+modular_exponentiation_montgomery(const montgomery_context_t* context, uint64_t a, uint64_t b);
+
+/*
+ * Modular Exponentiation (Batch)
+ *
+ * This function raises every base to the same power modulo
+ * the same number, as for the Fermat test of a modulus to
+ * many bases. The bases share the sequence of squarings and
+ * multiplications dictated by the exponent, so they are
+ * exponentiated in lockstep, eight at a time in the lanes
+ * of a vector register with AVX-512 IFMA, or four at a time
+ * with AVX2, where the modulus is small enough for the
+ * narrower multipliers.
+ *
+ * @param[in] context The modulus.
+ * @param[in] bases The numbers to raise to a power.
+ * @param[in] exponent The power to raise every base to.
+ * @param[out] results The powers, one per base.
+ * @param[in] count The number of bases.
+ *
+ */
+void
+__attribute__((nonnull(1,2,4)))
+modular_exponentiation_batch(const montgomery_context_t* context, const uint64_t* bases, uint64_t exponent, uint64_t* results, size_t count);
+
+#ifdef XLIBS_INTERNAL
+
+/*
+ * Calculate the greatest common divisor of two unsigned
+ * 64-bit integers.
+ *
+ */
+uint64_t __attribute_const binary_gcd64(uint64_t u, uint64_t v);
+
+/*
+ * Prepare Montgomery arithmetic modulo an odd number.
+ *
+ * The inverse of the modulus modulo 2^64 is found with
+ * Newton's iteration, each step of which doubles the number
+ * of correct low bits, starting from the three bits that
+ * any odd number is its own inverse modulo 8 for.
  *
- * @cite cormen_introduction_2009
+ */
+static inline void initialize_montgomery(montgomery_context_t* montgomery, uint64_t modulus) {
+    uint64_t inverse = modulus;
+
+    for (int i = 0; i < 5; ++i) {
+        inverse *= 2 - (modulus * inverse);
+    }
+
+    montgomery->modulus = modulus;
+    montgomery->inverse = inverse;
+    montgomery->one = -modulus % modulus;
+    montgomery->square = (uint64_t) (((unsigned __int128) montgomery->one * montgomery->one) % modulus);
+}
+
+/*
+ * Reduce a product of two numbers below the modulus, times
+ * the inverse of R.
+ *
+ * Since t - mn vanishes modulo 2^64 for m = t/n mod 2^64,
+ * its high word is the difference of the high words of t
+ * and mn, which lies strictly between -n and n.
+ *
+ */
+static inline uint64_t montgomery_reduce(const montgomery_context_t* montgomery, unsigned __int128 t) {
+    const uint64_t m = (uint64_t) t * montgomery->inverse;
+    const uint64_t high = (uint64_t) (((unsigned __int128) m * montgomery->modulus) >> 64);
+    const uint64_t result = (uint64_t) (t >> 64) - high;
+
+    return ((uint64_t) (t >> 64) < high) ? result + montgomery->modulus : result;
+}
+
+/*
+ * Multiply two numbers in Montgomery form.
+ *
+ */
+static inline uint64_t montgomery_multiply(const montgomery_context_t* montgomery, uint64_t a, uint64_t b) {
+    return montgomery_reduce(montgomery, (unsigned __int128) a * b);
+}
+
+/*
+ * Convert a number below the modulus into Montgomery form.
+ *
+ */
+static inline uint64_t to_montgomery(const montgomery_context_t* montgomery, uint64_t a) {
+    return montgomery_multiply(montgomery, a, montgomery->square);
+}
+
+/*
+ * Convert a number out of Montgomery form.
  *
  */
-int
-__attribute__((pure))
-modular_exponentiation(int a, int b, int n);
+static inline uint64_t from_montgomery(const montgomery_context_t* montgomery, uint64_t a) {
+    return montgomery_reduce(montgomery, a);
+}
 
-int least_common_multiple(void);
+#endif /** XLIBS_INTERNAL */
 
 #endif /** PROJECT_INCLUDES_XMATH_H */
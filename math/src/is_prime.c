@@ -0,0 +1,381 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ * 
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ * 
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xmath.h"
+
+#ifndef MAX
+#define MAX(a,b) ((a < b) ? (b) : (a))
+#endif
+
+#ifndef MIN
+#define MIN(a,b) ((a > b) ? (b) : (a))
+#endif
+
+/**
+ * Is Prime Array Chunk
+ *
+ * The values of an array are handed out to the worker
+ * threads in chunks of this many, so that threads that
+ * happen to draw more primes, which take the longest to
+ * test, do not hold up the others.
+ *
+ * @def IS_PRIME_ARRAY_CHUNK
+ *
+ */
+#ifndef IS_PRIME_ARRAY_CHUNK
+#define IS_PRIME_ARRAY_CHUNK 4096
+#endif
+
+/**
+ * Is Prime Array Minimum Per Thread
+ *
+ * is_prime_array() only starts another thread for every
+ * this many values, since smaller arrays are tested before
+ * the thread would have started.
+ *
+ * @def IS_PRIME_ARRAY_MINIMUM_PER_THREAD
+ *
+ */
+#ifndef IS_PRIME_ARRAY_MINIMUM_PER_THREAD
+#define IS_PRIME_ARRAY_MINIMUM_PER_THREAD 16384
+#endif
+
+/**
+ * Is Prime Array Maximum Threads
+ *
+ * @def IS_PRIME_ARRAY_MAXIMUM_THREADS
+ *
+ */
+#ifndef IS_PRIME_ARRAY_MAXIMUM_THREADS
+#define IS_PRIME_ARRAY_MAXIMUM_THREADS 64
+#endif
+
+/**
+ * Small Prime
+ *
+ * An odd prime p, its inverse modulo 2^64, and the largest
+ * multiple of p that fits in 64 bits divided by p. Since
+ * multiplying by the inverse maps the multiples of p onto
+ * exactly the numbers up to that quotient, p divides n if
+ * and only if n times the inverse does not exceed it, which
+ * takes a multiplication instead of a division.
+ *
+ */
+typedef struct {
+    uint64_t prime;
+    uint64_t inverse;
+    uint64_t limit;
+} small_prime_t;
+
+/**
+ * Small Primes
+ *
+ * The odd primes every candidate is divided by before the
+ * Miller-Rabin test. Any number below the square of the
+ * next prime, 59, that none of them divides is prime.
+ *
+ */
+static const small_prime_t small_primes[] = {
+    { 3, UINT64_C(0xaaaaaaaaaaaaaaab), UINT64_C(0x5555555555555555) },
+    { 5, UINT64_C(0xcccccccccccccccd), UINT64_C(0x3333333333333333) },
+    { 7, UINT64_C(0x6db6db6db6db6db7), UINT64_C(0x2492492492492492) },
+    { 11, UINT64_C(0x2e8ba2e8ba2e8ba3), UINT64_C(0x1745d1745d1745d1) },
+    { 13, UINT64_C(0x4ec4ec4ec4ec4ec5), UINT64_C(0x13b13b13b13b13b1) },
+    { 17, UINT64_C(0xf0f0f0f0f0f0f0f1), UINT64_C(0x0f0f0f0f0f0f0f0f) },
+    { 19, UINT64_C(0x86bca1af286bca1b), UINT64_C(0x0d79435e50d79435) },
+    { 23, UINT64_C(0xd37a6f4de9bd37a7), UINT64_C(0x0b21642c8590b216) },
+    { 29, UINT64_C(0x34f72c234f72c235), UINT64_C(0x08d3dcb08d3dcb08) },
+    { 31, UINT64_C(0xef7bdef7bdef7bdf), UINT64_C(0x0842108421084210) },
+    { 37, UINT64_C(0x14c1bacf914c1bad), UINT64_C(0x06eb3e45306eb3e4) },
+    { 41, UINT64_C(0x8f9c18f9c18f9c19), UINT64_C(0x063e7063e7063e70) },
+    { 43, UINT64_C(0x82fa0be82fa0be83), UINT64_C(0x05f417d05f417d05) },
+    { 47, UINT64_C(0x51b3bea3677d46cf), UINT64_C(0x0572620ae4c415c9) },
+    { 53, UINT64_C(0x21cfb2b78c13521d), UINT64_C(0x04d4873ecade304d) }
+};
+
+/**
+ * Miller-Rabin Bases (32-bit)
+ *
+ * No odd composite below 4,759,123,141 is a strong
+ * pseudoprime to all of these bases.
+ *
+ * @cite jaeschke_strong_1993
+ *
+ */
+static const uint64_t miller_rabin_bases_32[] = {
+    2, 7, 61
+};
+
+/**
+ * Miller-Rabin Bases (64-bit)
+ *
+ * No odd composite below 2^64 is a strong pseudoprime to
+ * all of these bases, found by Jim Sinclair.
+ *
+ */
+static const uint64_t miller_rabin_bases_64[] = {
+    2, 325, 9375, 28178, 450775, 9780504, 1795265022
+};
+
+/**
+ * Montgomery Power
+ *
+ * @param[in] montgomery The modulus.
+ * @param[in] base The base, in Montgomery form.
+ * @param[in] exponent The exponent.
+ *
+ * @returns The base raised to the exponent, in Montgomery form.
+ *
+ */
+static inline uint64_t montgomery_power(const montgomery_context_t* montgomery, uint64_t base, uint64_t exponent) {
+    uint64_t result = montgomery->one;
+
+    while (exponent != 0) {
+        if (exponent & 1) {
+            result = montgomery_multiply(montgomery, result, base);
+        }
+
+        base = montgomery_multiply(montgomery, base, base);
+        exponent >>= 1;
+    }
+
+    return result;
+}
+
+/**
+ * Miller-Rabin Test
+ *
+ * Writing n - 1 = d 2^s with d odd, n passes the test for
+ * base a if a^d is 1 or -1 modulo n, or if one of its s - 1
+ * successive squares is -1, as every prime does. All of the
+ * arithmetic is done in Montgomery form, in which 1 and -1
+ * are R mod n and n - (R mod n). Bases which are multiples
+ * of n say nothing about it, and are skipped.
+ *
+ * @param[in] n The odd number to test, greater than 2.
+ * @param[in] bases The bases to test n with.
+ * @param[in] count The number of bases.
+ *
+ * @returns Whether n passes the test for every base.
+ *
+ * @cite miller_riemanns_1976
+ * @cite rabin_probabilistic_1980
+ *
+ */
+static bool_t miller_rabin(uint64_t n, const uint64_t* bases, size_t count) {
+    montgomery_context_t montgomery;
+
+    initialize_montgomery(&montgomery, n);
+
+    const int s = __builtin_ctzll(n - 1);
+    const uint64_t d = (n - 1) >> s;
+
+    const uint64_t one = montgomery.one;
+    const uint64_t minus_one = n - montgomery.one;
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t a = bases[i] % n;
+
+        if (a == 0) {
+            continue;
+        }
+
+        uint64_t x = montgomery_power(&montgomery, to_montgomery(&montgomery, a), d);
+
+        if ((x == one) || (x == minus_one)) {
+            continue;
+        }
+
+        int witness = 1;
+
+        for (int r = 1; r < s; ++r) {
+            x = montgomery_multiply(&montgomery, x, x);
+
+            if (x == minus_one) {
+                witness = 0;
+                break;
+            }
+        }
+
+        if (witness) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Is Prime
+ *
+ * @param[in] n The number to test for primality.
+ *
+ * @returns A boolean value which is true if \f$n\f$ is prime.
+ *
+ * @todo Write man page for this function.
+ *
+ */
+bool_t is_prime(uint64_t n) {
+    if (n < 4) {
+        return (n >= 2) ? true : false;
+    }
+
+    if ((n & 1) == 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof (small_primes) / sizeof (small_primes[0]); ++i) {
+        if (n * small_primes[i].inverse <= small_primes[i].limit) {
+            return (n == small_primes[i].prime) ? true : false;
+        }
+    }
+
+    if (n < 59 * 59) {
+        return true;
+    }
+
+    if (n < UINT64_C(4759123141)) {
+        return miller_rabin(n, miller_rabin_bases_32, sizeof (miller_rabin_bases_32) / sizeof (miller_rabin_bases_32[0]));
+    }
+
+    return miller_rabin(n, miller_rabin_bases_64, sizeof (miller_rabin_bases_64) / sizeof (miller_rabin_bases_64[0]));
+}
+
+/**
+ * Is Prime Array
+ *
+ * The state shared by the threads testing an array.
+ *
+ */
+typedef struct {
+    const uint64_t* values;
+    bool_t* results;
+    size_t count;
+    size_t next;
+} is_prime_array_t;
+
+/**
+ * Run Is Prime Array Worker
+ *
+ * Each worker repeatedly claims the next chunk of the array
+ * until none are left.
+ *
+ * @param[in,out] argument The shared state of the array.
+ *
+ * @returns NULL.
+ *
+ */
+static void* run_is_prime_array_worker(void* argument) {
+    is_prime_array_t* array = argument;
+
+    for (;;) {
+        const size_t begin = __atomic_fetch_add(&array->next, IS_PRIME_ARRAY_CHUNK, __ATOMIC_RELAXED);
+
+        if (begin >= array->count) {
+            break;
+        }
+
+        const size_t end = MIN(begin + IS_PRIME_ARRAY_CHUNK, array->count);
+
+        for (size_t i = begin; i < end; ++i) {
+            array->results[i] = is_prime(array->values[i]);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Count Is Prime Array Threads
+ *
+ * @param[in] count The number of values in the array.
+ *
+ * @returns The number of threads to spread the array over.
+ *
+ */
+static size_t count_is_prime_array_threads(size_t count) {
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    size_t threads = (processors > 0) ? (size_t) processors : 1;
+
+    threads = MIN(threads, (size_t) IS_PRIME_ARRAY_MAXIMUM_THREADS);
+    threads = MIN(threads, (count + IS_PRIME_ARRAY_MINIMUM_PER_THREAD - 1) / IS_PRIME_ARRAY_MINIMUM_PER_THREAD);
+
+    return MAX(threads, (size_t) 1);
+}
+
+/**
+ * Is Prime (Array)
+ *
+ * The calling thread is the first of the workers. If a
+ * thread cannot be started, the others simply take up its
+ * share of the chunks.
+ *
+ * @param[in] values The numbers to test for primality.
+ * @param[in] count The number of values.
+ * @param[out] results Whether each value is prime.
+ *
+ */
+void is_prime_array(const uint64_t* values, size_t count, bool_t* results) {
+    is_prime_array_t array = {
+        .values = values,
+        .results = results,
+        .count = count,
+        .next = 0
+    };
+
+    const size_t threads = count_is_prime_array_threads(count);
+
+    pthread_t* workers = calloc(threads, sizeof (pthread_t));
+    int* started = calloc(threads, sizeof (int));
+
+    if ((workers == NULL) || (started == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 1; i < threads; ++i) {
+        started[i] = (pthread_create(&workers[i], NULL, run_is_prime_array_worker, &array) == 0);
+    }
+
+    run_is_prime_array_worker(&array);
+
+    for (size_t i = 1; i < threads; ++i) {
+        if (started[i]) {
+            pthread_join(workers[i], NULL);
+        }
+    }
+
+    free(workers);
+    free(started);
+}
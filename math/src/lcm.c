@@ -0,0 +1,384 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ * 
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ * 
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xmath.h"
+
+#ifndef MAX
+#define MAX(a,b) ((a < b) ? (b) : (a))
+#endif
+
+#ifndef MIN
+#define MIN(a,b) ((a > b) ? (b) : (a))
+#endif
+
+/**
+ * LCM Array Minimum Per Thread
+ *
+ * lcm_array() only starts another thread for every this
+ * many values, since smaller arrays are reduced before the
+ * thread would have started.
+ *
+ * @def LCM_ARRAY_MINIMUM_PER_THREAD
+ *
+ */
+#ifndef LCM_ARRAY_MINIMUM_PER_THREAD
+#define LCM_ARRAY_MINIMUM_PER_THREAD 65536
+#endif
+
+/**
+ * LCM Array Maximum Threads
+ *
+ * @def LCM_ARRAY_MAXIMUM_THREADS
+ *
+ */
+#ifndef LCM_ARRAY_MAXIMUM_THREADS
+#define LCM_ARRAY_MAXIMUM_THREADS 64
+#endif
+
+/**
+ * LCM Array Poll Interval
+ *
+ * The number of values each thread reduces between checks
+ * of whether another thread has already settled the
+ * result.
+ *
+ * @def LCM_ARRAY_POLL_INTERVAL
+ *
+ */
+#ifndef LCM_ARRAY_POLL_INTERVAL
+#define LCM_ARRAY_POLL_INTERVAL 1024
+#endif
+
+/**
+ * Unsigned Absolute Value
+ *
+ * @param[in] x The number to evaluate the absolute value of.
+ *
+ * @returns The absolute value of x, which is representable
+ * even for the most negative value of int64_t.
+ *
+ */
+static inline uint64_t unsigned_absolute_value(int64_t x) {
+    return (x < 0) ? -((uint64_t) x) : (uint64_t) x;
+}
+
+/**
+ * Checked Least Common Multiple (64-bit)
+ *
+ * The least common multiple is computed as a / gcd(a, b) *
+ * b, dividing before multiplying so that only the result
+ * itself can overflow. The divisor is found from b reduced
+ * modulo a, which is much cheaper for the binary algorithm
+ * when b is much larger than a, as it is when a is the
+ * running multiple of a reduction and b the next value.
+ *
+ * @param[in] a First factor.
+ * @param[in] b Second factor.
+ * @param[in] limit The largest acceptable result.
+ * @param[out] result The least common multiple of a and b.
+ *
+ * @returns Nonzero if the least common multiple of a and b
+ * is at most limit.
+ *
+ */
+static inline int checked_lcm64(uint64_t a, uint64_t b, uint64_t limit, uint64_t* result) {
+    if ((a == 0) || (b == 0)) {
+        *result = 0;
+        return 1;
+    }
+
+    const uint64_t divisor = binary_gcd64(a, b % a);
+
+    return !__builtin_mul_overflow(a, b / divisor, result) && (*result <= limit);
+}
+
+/**
+ * Least Common Multiple
+ *
+ * @param[in] a First factor.
+ * @param[in] b Second factor.
+ *
+ * @returns The least common multiple of a and b, or zero
+ * with errno set to ERANGE if it is not representable.
+ *
+ * @todo Write man page for this function.
+ *
+ */
+int lcm(int a, int b) {
+    uint64_t result;
+
+    if (!checked_lcm64(unsigned_absolute_value(a), unsigned_absolute_value(b), INT_MAX, &result)) {
+        errno = ERANGE;
+        return 0;
+    }
+
+    return (int) result;
+}
+
+/**
+ * Least Common Multiple (64-bit)
+ *
+ * @param[in] a First factor.
+ * @param[in] b Second factor.
+ *
+ * @returns The least common multiple of a and b, or zero
+ * with errno set to ERANGE if it is not representable.
+ *
+ */
+int64_t lcm64(int64_t a, int64_t b) {
+    uint64_t result;
+
+    if (!checked_lcm64(unsigned_absolute_value(a), unsigned_absolute_value(b), INT64_MAX, &result)) {
+        errno = ERANGE;
+        return 0;
+    }
+
+    return (int64_t) result;
+}
+
+#ifdef __SIZEOF_INT128__
+
+/**
+ * Least Common Multiple (128-bit)
+ *
+ * @param[in] a First factor.
+ * @param[in] b Second factor.
+ *
+ * @returns The least common multiple of a and b, or zero
+ * with errno set to ERANGE if it is not representable.
+ *
+ */
+unsigned __int128 lcm128(unsigned __int128 a, unsigned __int128 b) {
+    if ((a == 0) || (b == 0)) {
+        return 0;
+    }
+
+    unsigned __int128 result;
+
+    if (__builtin_mul_overflow(a, b / gcd128(a, b % a), &result)) {
+        errno = ERANGE;
+        return 0;
+    }
+
+    return result;
+}
+
+#endif /** __SIZEOF_INT128__ */
+
+/**
+ * LCM Array Reduction
+ *
+ * The state shared by the threads reducing an array. Each
+ * thread reduces a contiguous share of the values. A zero
+ * anywhere makes the result zero, so the thread finding
+ * one raises a flag on which every thread stops. An
+ * overflow makes the result unrepresentable unless there is
+ * such a zero, so on the flag raised by the thread that
+ * overflows, every thread stops multiplying and only looks
+ * through the rest of its share for a zero.
+ *
+ */
+typedef struct {
+    const int64_t* values;
+    size_t count;
+    size_t threads;
+    int zero;
+    int overflow;
+} lcm_array_t;
+
+/**
+ * LCM Array Worker
+ *
+ * The share of the array reduced by a single thread, and
+ * its result.
+ *
+ */
+typedef struct {
+    lcm_array_t* reduction;
+    size_t begin;
+    size_t end;
+    uint64_t multiple;
+    int overflow;
+    pthread_t thread;
+} lcm_array_worker_t;
+
+/**
+ * Run LCM Array Worker
+ *
+ * @param[in,out] argument The worker to run.
+ *
+ * @returns NULL.
+ *
+ */
+static void* run_lcm_array_worker(void* argument) {
+    lcm_array_worker_t* worker = argument;
+    lcm_array_t* reduction = worker->reduction;
+
+    uint64_t multiple = 1;
+    int overflow = 0;
+
+    for (size_t i = worker->begin; i < worker->end; ++i) {
+        if ((i - worker->begin) % LCM_ARRAY_POLL_INTERVAL == 0) {
+            if (__atomic_load_n(&reduction->zero, __ATOMIC_RELAXED)) {
+                break;
+            }
+
+            overflow |= __atomic_load_n(&reduction->overflow, __ATOMIC_RELAXED);
+        }
+
+        const uint64_t value = unsigned_absolute_value(reduction->values[i]);
+
+        if (value == 0) {
+            multiple = 0;
+            __atomic_store_n(&reduction->zero, 1, __ATOMIC_RELAXED);
+            break;
+        }
+
+        if (!overflow && !checked_lcm64(multiple, value, INT64_MAX, &multiple)) {
+            overflow = 1;
+            __atomic_store_n(&reduction->overflow, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    worker->multiple = multiple;
+    worker->overflow = overflow;
+
+    return NULL;
+}
+
+/**
+ * Count LCM Array Threads
+ *
+ * @param[in] count The number of values in the array.
+ *
+ * @returns The number of threads to spread the reduction over.
+ *
+ */
+static size_t count_lcm_array_threads(size_t count) {
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    size_t threads = (processors > 0) ? (size_t) processors : 1;
+
+    threads = MIN(threads, (size_t) LCM_ARRAY_MAXIMUM_THREADS);
+    threads = MIN(threads, (count + LCM_ARRAY_MINIMUM_PER_THREAD - 1) / LCM_ARRAY_MINIMUM_PER_THREAD);
+
+    return MAX(threads, (size_t) 1);
+}
+
+/**
+ * Least Common Multiple of an Array
+ *
+ * The array is split into one contiguous share per thread,
+ * the calling thread being the first of them, and the least
+ * common multiples of the shares are then combined. Since
+ * the multiple of a share divides that of the whole array,
+ * the reduction overflows if any share does. If a thread
+ * cannot be started, the calling thread reduces its share
+ * itself.
+ *
+ * @param[in] values The numbers to take the multiple of.
+ * @param[in] count The number of values.
+ *
+ * @returns The least common multiple of the values, one if
+ * there are none, or zero with errno set to ERANGE if it is
+ * not representable.
+ *
+ */
+int64_t lcm_array(const int64_t* values, size_t count) {
+    lcm_array_t reduction = {
+        .values = values,
+        .count = count,
+        .threads = count_lcm_array_threads(count),
+        .zero = 0,
+        .overflow = 0
+    };
+
+    lcm_array_worker_t* workers = calloc(reduction.threads, sizeof (lcm_array_worker_t));
+    int* started = calloc(reduction.threads, sizeof (int));
+
+    if ((workers == NULL) || (started == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < reduction.threads; ++i) {
+        workers[i].reduction = &reduction;
+        workers[i].begin = (count / reduction.threads) * i;
+        workers[i].end = (i + 1 == reduction.threads) ? count : (count / reduction.threads) * (i + 1);
+    }
+
+    for (size_t i = 1; i < reduction.threads; ++i) {
+        started[i] = (pthread_create(&workers[i].thread, NULL, run_lcm_array_worker, &workers[i]) == 0);
+    }
+
+    run_lcm_array_worker(&workers[0]);
+
+    for (size_t i = 1; i < reduction.threads; ++i) {
+        if (started[i]) {
+            pthread_join(workers[i].thread, NULL);
+        } else {
+            run_lcm_array_worker(&workers[i]);
+        }
+    }
+
+    uint64_t multiple = 1;
+    int overflow = 0;
+
+    for (size_t i = 0; i < reduction.threads; ++i) {
+        overflow |= workers[i].overflow;
+
+        if (workers[i].multiple == 0) {
+            multiple = 0;
+        }
+    }
+
+    if (multiple == 0) {
+        overflow = 0;
+    }
+
+    for (size_t i = 0; (i < reduction.threads) && (multiple != 0) && !overflow; ++i) {
+        overflow = !checked_lcm64(multiple, workers[i].multiple, INT64_MAX, &multiple);
+    }
+
+    free(workers);
+    free(started);
+
+    if (overflow) {
+        errno = ERANGE;
+        return 0;
+    }
+
+    return (int64_t) multiple;
+}
@@ -0,0 +1,745 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ * 
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ * 
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xmath.h"
+
+#ifndef MAX
+#define MAX(a,b) ((a < b) ? (b) : (a))
+#endif
+
+#ifndef MIN
+#define MIN(a,b) ((a > b) ? (b) : (a))
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+
+/**
+ * This macro is defined when the vectorized implementations
+ * of the batch modular exponentiation are available.
+ *
+ * @def XLIBS_MODULAR_EXPONENTIATION_SIMD
+ *
+ */
+#define XLIBS_MODULAR_EXPONENTIATION_SIMD
+#endif
+
+/**
+ * Modular Exponentiation Lanes
+ *
+ * The number of bases the generic batch exponentiation
+ * raises in lockstep. Each Montgomery multiplication
+ * depends on the previous one, so a single exponentiation
+ * leaves most of the multiplier idle, whereas those of
+ * independent bases overlap.
+ *
+ * @def MODULAR_EXPONENTIATION_LANES
+ *
+ */
+#ifndef MODULAR_EXPONENTIATION_LANES
+#define MODULAR_EXPONENTIATION_LANES 4
+#endif
+
+/**
+ * Modular Exponentiation Maximum Window
+ *
+ * The widest window of exponent bits the sliding-window
+ * method multiplies by at once. A window of w bits needs a
+ * table of the first 2^(w-1) odd powers of the base, so the
+ * table costs as many multiplications to build as the
+ * windows save beyond three bits for 64-bit exponents.
+ *
+ * @def MODULAR_EXPONENTIATION_MAXIMUM_WINDOW
+ *
+ */
+#ifndef MODULAR_EXPONENTIATION_MAXIMUM_WINDOW
+#define MODULAR_EXPONENTIATION_MAXIMUM_WINDOW 3
+#endif
+
+/**
+ * The number of odd powers of the base kept for the widest
+ * window.
+ *
+ */
+#define MODULAR_EXPONENTIATION_TABLE_SIZE (1 << (MODULAR_EXPONENTIATION_MAXIMUM_WINDOW - 1))
+
+/**
+ * Exponent Schedule
+ *
+ * The sequence of operations the sliding-window method
+ * performs for an exponent, which depends on the exponent
+ * alone, so that it may be worked out once and replayed for
+ * every base.
+ *
+ * The result starts out as the odd power of the base given
+ * by the first window. Each later window squares the result
+ * as many times as the bits it moves past, and multiplies
+ * it by the odd power given by the window, and the zero bits
+ * past the last window square it once each.
+ *
+ */
+typedef struct {
+    unsigned int table_size;
+    unsigned int count;
+    unsigned char squarings[64];
+    unsigned char powers[64];
+    unsigned int trailing;
+} exponent_schedule_t;
+
+/**
+ * Schedule Exponent
+ *
+ * This function scans the bits of the exponent from the
+ * most significant down, cutting them into windows of at
+ * most the chosen width, each starting and ending with a
+ * set bit. The width is the one which needs the fewest
+ * multiplications, counting the squarings and
+ * multiplications needed to build the table of odd powers,
+ * for an exponent of that many bits.
+ *
+ * @param[out] schedule The schedule of the exponent.
+ * @param[in] exponent The exponent, which must not be zero.
+ *
+ */
+static void schedule_exponent(exponent_schedule_t* schedule, uint64_t exponent) {
+    const int bits = 64 - __builtin_clzll(exponent);
+    const int preferred = (bits > 24) ? 3 : ((bits > 6) ? 2 : 1);
+    const int width = MIN(preferred, MODULAR_EXPONENTIATION_MAXIMUM_WINDOW);
+
+    schedule->table_size = 1u << (width - 1);
+    schedule->count = 0;
+
+    int squarings = 0;
+    int i = bits - 1;
+
+    while (i >= 0) {
+        if (((exponent >> i) & 1) == 0) {
+            ++squarings;
+            --i;
+            continue;
+        }
+
+        int j = MAX(i - width + 1, 0);
+
+        while (((exponent >> j) & 1) == 0) {
+            ++j;
+        }
+
+        const uint64_t window = (exponent >> j) & ((UINT64_C(2) << (i - j)) - 1);
+
+        schedule->squarings[schedule->count] = (unsigned char) (squarings + (i - j + 1));
+        schedule->powers[schedule->count] = (unsigned char) (window >> 1);
+        ++schedule->count;
+
+        squarings = 0;
+        i = j - 1;
+    }
+
+    schedule->trailing = (unsigned int) squarings;
+}
+
+/**
+ * Montgomery Power
+ *
+ * This function replays the schedule of an exponent for a
+ * single base.
+ *
+ * @param[in] context The modulus.
+ * @param[in] schedule The schedule of the exponent.
+ * @param[in] base The base, in Montgomery form.
+ *
+ * @returns The power, in Montgomery form.
+ *
+ */
+static uint64_t montgomery_power(const montgomery_context_t* context, const exponent_schedule_t* schedule, uint64_t base) {
+    uint64_t table[MODULAR_EXPONENTIATION_TABLE_SIZE];
+
+    table[0] = base;
+
+    if (schedule->table_size > 1) {
+        const uint64_t square = montgomery_multiply(context, base, base);
+
+        for (unsigned int k = 1; k < schedule->table_size; ++k) {
+            table[k] = montgomery_multiply(context, table[k - 1], square);
+        }
+    }
+
+    uint64_t result = table[schedule->powers[0]];
+
+    for (unsigned int w = 1; w < schedule->count; ++w) {
+        for (unsigned int s = 0; s < schedule->squarings[w]; ++s) {
+            result = montgomery_multiply(context, result, result);
+        }
+
+        result = montgomery_multiply(context, result, table[schedule->powers[w]]);
+    }
+
+    for (unsigned int s = 0; s < schedule->trailing; ++s) {
+        result = montgomery_multiply(context, result, result);
+    }
+
+    return result;
+}
+
+/**
+ * Initialize Montgomery Context
+ *
+ * @param[out] context The context to initialize.
+ * @param[in] modulus The modulus, which must be odd.
+ *
+ * @returns True if the context was initialized, or false
+ * if the modulus is even.
+ *
+ */
+bool_t initialize_montgomery_context(montgomery_context_t* context, uint64_t modulus) {
+    if ((modulus & 1) == 0) {
+        return false;
+    }
+
+    initialize_montgomery(context, modulus);
+
+    return true;
+}
+
+/**
+ * Modular Exponentiation (Montgomery Context)
+ *
+ * Any 64-bit base may be put into Montgomery form directly,
+ * without first reducing it, since its product with R^2 mod
+ * n is less than nR, as the reduction requires.
+ *
+ * @param[in] context The modulus.
+ * @param[in] a Number to raise to a power.
+ * @param[in] b The power to raise a to.
+ *
+ * @returns a^b mod n.
+ *
+ */
+uint64_t modular_exponentiation_montgomery(const montgomery_context_t* context, uint64_t a, uint64_t b) {
+    if (b == 0) {
+        return from_montgomery(context, context->one);
+    }
+
+    exponent_schedule_t schedule;
+
+    schedule_exponent(&schedule, b);
+
+    return from_montgomery(context, montgomery_power(context, &schedule, to_montgomery(context, a)));
+}
+
+/**
+ * Modular Exponentiation (Even Modulus)
+ *
+ * This function computes a^b mod n by right-to-left binary
+ * exponentiation, reducing each product by division.
+ *
+ * @param[in] a Number to raise to a power.
+ * @param[in] b The power to raise a to.
+ * @param[in] n The modulus, which must not be zero.
+ *
+ * @returns a^b mod n.
+ *
+ */
+static uint64_t modular_exponentiation_division(uint64_t a, uint64_t b, uint64_t n) {
+    uint64_t result = 1 % n;
+
+    a %= n;
+
+    while (b != 0) {
+        if (b & 1) {
+            result = (uint64_t) (((unsigned __int128) result * a) % n);
+        }
+
+        a = (uint64_t) (((unsigned __int128) a * a) % n);
+        b >>= 1;
+    }
+
+    return result;
+}
+
+/**
+ * Modular Exponentiation
+ *
+ * @param[in] a Number to raise to a power.
+ * @param[in] b The power to raise a to.
+ * @param[in] n The modulus to reduce a^b by.
+ *
+ * @returns a^b mod n, or zero if n is zero.
+ *
+ */
+uint64_t modular_exponentiation(uint64_t a, uint64_t b, uint64_t n) {
+    if (n == 0) {
+        return 0;
+    }
+
+    montgomery_context_t context;
+
+    if (!initialize_montgomery_context(&context, n)) {
+        return modular_exponentiation_division(a, b, n);
+    }
+
+    return modular_exponentiation_montgomery(&context, a, b);
+}
+
+/**
+ * Modular Exponentiation Batch (Generic)
+ *
+ * This function raises the bases in groups of lanes, each
+ * step of the schedule being applied to every lane of the
+ * group before moving on to the next.
+ *
+ * @param[in] context The modulus.
+ * @param[in] schedule The schedule of the exponent.
+ * @param[in] bases The numbers to raise to a power.
+ * @param[out] results The powers, one per base.
+ * @param[in] count The number of bases.
+ *
+ */
+static void modular_exponentiation_batch_generic(const montgomery_context_t* context, const exponent_schedule_t* schedule, const uint64_t* bases, uint64_t* results, size_t count) {
+    size_t i = 0;
+
+    for (; i + MODULAR_EXPONENTIATION_LANES <= count; i += MODULAR_EXPONENTIATION_LANES) {
+        uint64_t table[MODULAR_EXPONENTIATION_TABLE_SIZE][MODULAR_EXPONENTIATION_LANES];
+        uint64_t result[MODULAR_EXPONENTIATION_LANES];
+
+        for (size_t l = 0; l < MODULAR_EXPONENTIATION_LANES; ++l) {
+            table[0][l] = to_montgomery(context, bases[i + l]);
+            result[l] = montgomery_multiply(context, table[0][l], table[0][l]);
+        }
+
+        for (unsigned int k = 1; k < schedule->table_size; ++k) {
+            for (size_t l = 0; l < MODULAR_EXPONENTIATION_LANES; ++l) {
+                table[k][l] = montgomery_multiply(context, table[k - 1][l], result[l]);
+            }
+        }
+
+        for (size_t l = 0; l < MODULAR_EXPONENTIATION_LANES; ++l) {
+            result[l] = table[schedule->powers[0]][l];
+        }
+
+        for (unsigned int w = 1; w < schedule->count; ++w) {
+            for (unsigned int s = 0; s < schedule->squarings[w]; ++s) {
+                for (size_t l = 0; l < MODULAR_EXPONENTIATION_LANES; ++l) {
+                    result[l] = montgomery_multiply(context, result[l], result[l]);
+                }
+            }
+
+            for (size_t l = 0; l < MODULAR_EXPONENTIATION_LANES; ++l) {
+                result[l] = montgomery_multiply(context, result[l], table[schedule->powers[w]][l]);
+            }
+        }
+
+        for (unsigned int s = 0; s < schedule->trailing; ++s) {
+            for (size_t l = 0; l < MODULAR_EXPONENTIATION_LANES; ++l) {
+                result[l] = montgomery_multiply(context, result[l], result[l]);
+            }
+        }
+
+        for (size_t l = 0; l < MODULAR_EXPONENTIATION_LANES; ++l) {
+            results[i + l] = from_montgomery(context, result[l]);
+        }
+    }
+
+    for (; i < count; ++i) {
+        results[i] = from_montgomery(context, montgomery_power(context, schedule, to_montgomery(context, bases[i])));
+    }
+}
+
+#ifdef XLIBS_MODULAR_EXPONENTIATION_SIMD
+
+/**
+ * Narrow Montgomery Constants
+ *
+ * The constants of Montgomery arithmetic with R = 2^k for a
+ * modulus n below 2^k, for the vector multipliers, which
+ * are narrower than 64 bits: the negated inverse of n
+ * modulo R, and R^2 mod n.
+ *
+ * @param[in] context The modulus.
+ * @param[in] bits The number of bits k of R.
+ * @param[out] inverse The negated inverse of the modulus.
+ * @param[out] square R^2 mod n.
+ *
+ */
+static void initialize_narrow_montgomery(const montgomery_context_t* context, unsigned int bits, uint64_t* inverse, uint64_t* square) {
+    const uint64_t mask = (UINT64_C(1) << bits) - 1;
+    const uint64_t one = (UINT64_C(1) << bits) % context->modulus;
+
+    *inverse = (0 - context->inverse) & mask;
+    *square = (uint64_t) (((unsigned __int128) one * one) % context->modulus);
+}
+
+/**
+ * Reduce Base
+ *
+ * Reduce a base modulo n with a Montgomery reduction of its
+ * product with R mod n, instead of a division.
+ *
+ * @param[in] context The modulus.
+ * @param[in] base The number to reduce.
+ *
+ * @returns The base modulo n.
+ *
+ */
+static inline uint64_t reduce_base(const montgomery_context_t* context, uint64_t base) {
+    return montgomery_multiply(context, base, context->one);
+}
+
+/**
+ * Montgomery Multiply (AVX-512 IFMA)
+ *
+ * This function multiplies eight pairs of numbers in
+ * Montgomery form with R = 2^52, one per lane, using the
+ * 52-bit multiply-add instructions, which yield the low and
+ * high halves of the 104-bit products.
+ *
+ * The sum of ab and mn vanishes modulo R, so its low halves
+ * only carry into the high ones, and the high halves of the
+ * two products, plus that carry, are less than 2n, which
+ * one conditional subtraction reduces below n.
+ *
+ * @param[in] a Eight numbers below the modulus.
+ * @param[in] b Eight numbers below the modulus.
+ * @param[in] modulus The modulus, in every lane.
+ * @param[in] inverse The negated inverse of the modulus, in every lane.
+ *
+ * @returns abR^-1 mod n, in every lane.
+ *
+ */
+__attribute__((target("avx512f,avx512ifma")))
+static inline __m512i montgomery_multiply_avx512ifma(__m512i a, __m512i b, __m512i modulus, __m512i inverse) {
+    const __m512i zero = _mm512_setzero_si512();
+
+    const __m512i low = _mm512_madd52lo_epu64(zero, a, b);
+    const __m512i high = _mm512_madd52hi_epu64(zero, a, b);
+    const __m512i m = _mm512_madd52lo_epu64(zero, low, inverse);
+    const __m512i carry = _mm512_srli_epi64(_mm512_madd52lo_epu64(low, m, modulus), 52);
+    const __m512i result = _mm512_add_epi64(_mm512_madd52hi_epu64(high, m, modulus), carry);
+
+    return _mm512_min_epu64(result, _mm512_sub_epi64(result, modulus));
+}
+
+/**
+ * Modular Exponentiation Batch (AVX-512 IFMA)
+ *
+ * This function raises eight bases at a time, one per lane,
+ * for moduli below 2^52.
+ *
+ * @param[in] context The modulus.
+ * @param[in] schedule The schedule of the exponent.
+ * @param[in] bases The numbers to raise to a power.
+ * @param[out] results The powers, one per base.
+ * @param[in] count The number of bases.
+ *
+ */
+__attribute__((target("avx512f,avx512ifma")))
+static void modular_exponentiation_batch_avx512ifma(const montgomery_context_t* context, const exponent_schedule_t* schedule, const uint64_t* bases, uint64_t* results, size_t count) {
+    uint64_t narrow_inverse;
+    uint64_t narrow_square;
+
+    initialize_narrow_montgomery(context, 52, &narrow_inverse, &narrow_square);
+
+    const __m512i modulus = _mm512_set1_epi64((long long) context->modulus);
+    const __m512i inverse = _mm512_set1_epi64((long long) narrow_inverse);
+    const __m512i square = _mm512_set1_epi64((long long) narrow_square);
+    const __m512i one = _mm512_set1_epi64(1);
+
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        uint64_t reduced[8];
+
+        for (size_t l = 0; l < 8; ++l) {
+            reduced[l] = reduce_base(context, bases[i + l]);
+        }
+
+        __m512i table[MODULAR_EXPONENTIATION_TABLE_SIZE];
+
+        table[0] = montgomery_multiply_avx512ifma(_mm512_loadu_si512((const void*) reduced), square, modulus, inverse);
+
+        if (schedule->table_size > 1) {
+            const __m512i base_square = montgomery_multiply_avx512ifma(table[0], table[0], modulus, inverse);
+
+            for (unsigned int k = 1; k < schedule->table_size; ++k) {
+                table[k] = montgomery_multiply_avx512ifma(table[k - 1], base_square, modulus, inverse);
+            }
+        }
+
+        __m512i result = table[schedule->powers[0]];
+
+        for (unsigned int w = 1; w < schedule->count; ++w) {
+            for (unsigned int s = 0; s < schedule->squarings[w]; ++s) {
+                result = montgomery_multiply_avx512ifma(result, result, modulus, inverse);
+            }
+
+            result = montgomery_multiply_avx512ifma(result, table[schedule->powers[w]], modulus, inverse);
+        }
+
+        for (unsigned int s = 0; s < schedule->trailing; ++s) {
+            result = montgomery_multiply_avx512ifma(result, result, modulus, inverse);
+        }
+
+        _mm512_storeu_si512((void*) (results + i), montgomery_multiply_avx512ifma(result, one, modulus, inverse));
+    }
+
+    modular_exponentiation_batch_generic(context, schedule, bases + i, results + i, count - i);
+}
+
+/**
+ * Montgomery Multiply (AVX2)
+ *
+ * This function multiplies four pairs of numbers in
+ * Montgomery form with R = 2^32, one per 64-bit lane, using
+ * the unsigned 32-bit multiplication, which only reads the
+ * low half of each lane, so m needs no masking.
+ *
+ * The sum of ab and mn may not fit in 64 bits, so their
+ * high halves are added instead, plus the carry out of the
+ * low halves, which is one unless the low half of ab is
+ * zero. Every lane is below 2^33, so the signed comparison
+ * suffices for the final subtraction.
+ *
+ * @param[in] a Four numbers below the modulus.
+ * @param[in] b Four numbers below the modulus.
+ * @param[in] modulus The modulus, in every lane.
+ * @param[in] inverse The negated inverse of the modulus, in every lane.
+ *
+ * @returns abR^-1 mod n, in every lane.
+ *
+ */
+__attribute__((target("avx2")))
+static inline __m256i montgomery_multiply_avx2(__m256i a, __m256i b, __m256i modulus, __m256i inverse) {
+    const __m256i low_mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i one = _mm256_set1_epi64x(1);
+
+    const __m256i t = _mm256_mul_epu32(a, b);
+    const __m256i m = _mm256_mul_epu32(t, inverse);
+    const __m256i mn = _mm256_mul_epu32(m, modulus);
+
+    /** All ones in the lanes where the low half of ab is zero. */
+    const __m256i no_carry = _mm256_cmpeq_epi64(_mm256_and_si256(t, low_mask), _mm256_setzero_si256());
+
+    const __m256i result = _mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(t, 32), _mm256_srli_epi64(mn, 32)), _mm256_add_epi64(one, no_carry));
+    const __m256i below = _mm256_cmpgt_epi64(modulus, result);
+
+    return _mm256_sub_epi64(result, _mm256_andnot_si256(below, modulus));
+}
+
+/**
+ * Modular Exponentiation Batch (AVX2)
+ *
+ * This function raises four bases at a time, one per lane,
+ * for moduli below 2^32.
+ *
+ * @param[in] context The modulus.
+ * @param[in] schedule The schedule of the exponent.
+ * @param[in] bases The numbers to raise to a power.
+ * @param[out] results The powers, one per base.
+ * @param[in] count The number of bases.
+ *
+ */
+__attribute__((target("avx2")))
+static void modular_exponentiation_batch_avx2(const montgomery_context_t* context, const exponent_schedule_t* schedule, const uint64_t* bases, uint64_t* results, size_t count) {
+    uint64_t narrow_inverse;
+    uint64_t narrow_square;
+
+    initialize_narrow_montgomery(context, 32, &narrow_inverse, &narrow_square);
+
+    const __m256i modulus = _mm256_set1_epi64x((long long) context->modulus);
+    const __m256i inverse = _mm256_set1_epi64x((long long) narrow_inverse);
+    const __m256i square = _mm256_set1_epi64x((long long) narrow_square);
+    const __m256i one = _mm256_set1_epi64x(1);
+
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        uint64_t reduced[4];
+
+        for (size_t l = 0; l < 4; ++l) {
+            reduced[l] = reduce_base(context, bases[i + l]);
+        }
+
+        __m256i table[MODULAR_EXPONENTIATION_TABLE_SIZE];
+
+        table[0] = montgomery_multiply_avx2(_mm256_loadu_si256((const __m256i*) reduced), square, modulus, inverse);
+
+        if (schedule->table_size > 1) {
+            const __m256i base_square = montgomery_multiply_avx2(table[0], table[0], modulus, inverse);
+
+            for (unsigned int k = 1; k < schedule->table_size; ++k) {
+                table[k] = montgomery_multiply_avx2(table[k - 1], base_square, modulus, inverse);
+            }
+        }
+
+        __m256i result = table[schedule->powers[0]];
+
+        for (unsigned int w = 1; w < schedule->count; ++w) {
+            for (unsigned int s = 0; s < schedule->squarings[w]; ++s) {
+                result = montgomery_multiply_avx2(result, result, modulus, inverse);
+            }
+
+            result = montgomery_multiply_avx2(result, table[schedule->powers[w]], modulus, inverse);
+        }
+
+        for (unsigned int s = 0; s < schedule->trailing; ++s) {
+            result = montgomery_multiply_avx2(result, result, modulus, inverse);
+        }
+
+        _mm256_storeu_si256((__m256i*) (results + i), montgomery_multiply_avx2(result, one, modulus, inverse));
+    }
+
+    modular_exponentiation_batch_generic(context, schedule, bases + i, results + i, count - i);
+}
+
+#endif /** XLIBS_MODULAR_EXPONENTIATION_SIMD */
+
+/**
+ * Modular Exponentiation Batch Function
+ *
+ * @typedef modular_exponentiation_batch_function_t
+ *
+ */
+typedef void (*modular_exponentiation_batch_function_t)(const montgomery_context_t*, const exponent_schedule_t*, const uint64_t*, uint64_t*, size_t);
+
+#ifdef XLIBS_MODULAR_EXPONENTIATION_SIMD
+
+/**
+ * Modular Exponentiation Host Features
+ *
+ * The instruction set extensions the vectorized batches
+ * need, as bits of the features the host supports. The
+ * features are known once the known bit is set.
+ *
+ * @def MODULAR_EXPONENTIATION_FEATURES_KNOWN
+ * @def MODULAR_EXPONENTIATION_AVX2
+ * @def MODULAR_EXPONENTIATION_AVX512IFMA
+ *
+ */
+#define MODULAR_EXPONENTIATION_FEATURES_KNOWN (1U << 0)
+#define MODULAR_EXPONENTIATION_AVX2 (1U << 1)
+#define MODULAR_EXPONENTIATION_AVX512IFMA (1U << 2)
+
+/**
+ * The features of the host, or zero until the first batch
+ * inspects it.
+ *
+ */
+static unsigned int modular_exponentiation_host_features = 0;
+
+/**
+ * Get Modular Exponentiation Host Features
+ *
+ * The host is only inspected by the first call, and every
+ * later one reuses its findings. Racing first calls all
+ * find the same features, so they only need to be read and
+ * written atomically.
+ *
+ * @returns The features of the host.
+ *
+ */
+static unsigned int get_modular_exponentiation_host_features(void) {
+    unsigned int features = __atomic_load_n(&modular_exponentiation_host_features, __ATOMIC_RELAXED);
+
+    if (features == 0) {
+        __builtin_cpu_init();
+
+        features = MODULAR_EXPONENTIATION_FEATURES_KNOWN;
+
+        if (__builtin_cpu_supports("avx2")) {
+            features |= MODULAR_EXPONENTIATION_AVX2;
+        }
+
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma")) {
+            features |= MODULAR_EXPONENTIATION_AVX512IFMA;
+        }
+
+        __atomic_store_n(&modular_exponentiation_host_features, features, __ATOMIC_RELAXED);
+    }
+
+    return features;
+}
+
+#endif /** XLIBS_MODULAR_EXPONENTIATION_SIMD */
+
+/**
+ * Get Modular Exponentiation Batch Function
+ *
+ * The vectorized implementations are only chosen for the
+ * moduli their multipliers are wide enough for. The modulus
+ * is checked on every call, but the host only once.
+ *
+ * @param[in] context The modulus.
+ *
+ * @returns The fastest implementation the host supports for
+ * the modulus.
+ *
+ */
+static modular_exponentiation_batch_function_t get_modular_exponentiation_batch_function(const montgomery_context_t* context) {
+#ifdef XLIBS_MODULAR_EXPONENTIATION_SIMD
+    const unsigned int features = get_modular_exponentiation_host_features();
+
+    if ((context->modulus < (UINT64_C(1) << 52)) && (features & MODULAR_EXPONENTIATION_AVX512IFMA)) {
+        return modular_exponentiation_batch_avx512ifma;
+    }
+
+    if ((context->modulus < (UINT64_C(1) << 32)) && (features & MODULAR_EXPONENTIATION_AVX2)) {
+        return modular_exponentiation_batch_avx2;
+    }
+#endif
+
+    return modular_exponentiation_batch_generic;
+}
+
+/**
+ * Modular Exponentiation (Batch)
+ *
+ * @param[in] context The modulus.
+ * @param[in] bases The numbers to raise to a power.
+ * @param[in] exponent The power to raise every base to.
+ * @param[out] results The powers, one per base.
+ * @param[in] count The number of bases.
+ *
+ */
+void modular_exponentiation_batch(const montgomery_context_t* context, const uint64_t* bases, uint64_t exponent, uint64_t* results, size_t count) {
+    if (exponent == 0) {
+        const uint64_t one = from_montgomery(context, context->one);
+
+        for (size_t i = 0; i < count; ++i) {
+            results[i] = one;
+        }
+
+        return;
+    }
+
+    exponent_schedule_t schedule;
+
+    schedule_exponent(&schedule, exponent);
+
+    get_modular_exponentiation_batch_function(context)(context, &schedule, bases, results, count);
+}
@@ -0,0 +1,950 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ * 
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ * 
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xmath.h"
+
+#ifndef MAX
+#define MAX(a,b) ((a < b) ? (b) : (a))
+#endif
+
+#ifndef MIN
+#define MIN(a,b) ((a > b) ? (b) : (a))
+#endif
+
+/**
+ * Prime Sieve Segment Size
+ *
+ * The number of bytes of the sieve crossed off by every
+ * sieving prime in turn before moving on to the next
+ * segment. A segment should fit in the L1 data cache, so
+ * that the scattered writes of the small primes never leave
+ * it. Each byte covers thirty numbers.
+ *
+ * @def PRIME_SIEVE_SEGMENT_BYTES
+ *
+ */
+#ifndef PRIME_SIEVE_SEGMENT_BYTES
+#define PRIME_SIEVE_SEGMENT_BYTES 32768
+#endif
+
+/**
+ * Prime Sieve Block Size
+ *
+ * The number of bytes of the sieve handed to a thread at a
+ * time, a whole number of segments. A block should fit in
+ * the L2 cache. The position of every sieving prime is
+ * computed afresh with a division at the start of each
+ * block, and then carried from segment to segment, so
+ * larger blocks make that cost negligible.
+ *
+ * @def PRIME_SIEVE_BLOCK_BYTES
+ *
+ */
+#ifndef PRIME_SIEVE_BLOCK_BYTES
+#define PRIME_SIEVE_BLOCK_BYTES (8 * PRIME_SIEVE_SEGMENT_BYTES)
+#endif
+
+/**
+ * Prime Sieve Maximum Threads
+ *
+ * @def PRIME_SIEVE_MAXIMUM_THREADS
+ *
+ */
+#ifndef PRIME_SIEVE_MAXIMUM_THREADS
+#define PRIME_SIEVE_MAXIMUM_THREADS 64
+#endif
+
+/**
+ * Wheel Residues
+ *
+ * The residues modulo 30 of the numbers coprime to 30. Only
+ * these numbers are stored in the sieve, one bit each, so a
+ * byte holds the eight candidates among thirty consecutive
+ * numbers, and bit k of byte j stands for 30j + residue[k].
+ *
+ */
+static const unsigned int wheel_residues[8] = {
+    1, 7, 11, 13, 17, 19, 23, 29
+};
+
+/**
+ * Wheel Steps
+ *
+ * The distance from each residue of the wheel to the next,
+ * wrapping around to 31.
+ *
+ */
+static const unsigned int wheel_steps[8] = {
+    6, 4, 2, 4, 2, 4, 6, 2
+};
+
+/**
+ * Wheel Positions
+ *
+ * The bit of a byte of the sieve standing for each residue
+ * of the wheel, the inverse of the wheel residues.
+ *
+ */
+static const unsigned char wheel_positions[30] = {
+    0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 2, 0, 3, 0, 0, 0, 4, 0, 5, 0, 0, 0, 6, 0, 0, 0, 0, 0, 7
+};
+
+/**
+ * The primes below 7, which the wheel leaves out.
+ *
+ */
+static const uint64_t wheel_primes[3] = {
+    2, 3, 5
+};
+
+/**
+ * Prime Sieve
+ *
+ * The read-only description of a range being sieved, shared
+ * by every thread: its extent in bytes of the sieve, the
+ * sieving primes, and the tables that drive crossing off.
+ *
+ * A sieving prime p crosses off its multiples pq, for every
+ * q coprime to 30 no less than p. Stepping q through the
+ * wheel, both the bit that pq falls on and the number of
+ * bytes to the next multiple depend only on the residues of
+ * p and q modulo 30, so they are tabulated for each of the
+ * 64 pairs of residues, the latter less the part p / 30
+ * times the step of q, which is the same for any pair.
+ *
+ */
+typedef struct {
+    uint64_t low;
+    uint64_t high;
+    uint64_t first_byte;
+    uint64_t byte_count;
+    uint64_t block_count;
+    uint32_t* primes;
+    unsigned char* classes;
+    size_t count;
+    unsigned char masks[8][8];
+    unsigned char carries[8][8];
+    unsigned char next_position[30];
+    size_t threads;
+    uint64_t next_block;
+} prime_sieve_t;
+
+/**
+ * Prime Sieve Worker
+ *
+ * The memory private to each thread: the block it sieves,
+ * and the position of every sieving prime within it.
+ *
+ */
+typedef struct {
+    prime_sieve_t* sieve;
+    unsigned char* buffer;
+    uint32_t* offsets;
+    unsigned char* positions;
+    uint64_t block;
+    size_t length;
+    uint64_t primes;
+    pthread_t thread;
+} prime_sieve_worker_t;
+
+/**
+ * Integer Square Root
+ *
+ * @param[in] n The number to take the square root of.
+ *
+ * @returns The largest number whose square does not exceed n.
+ *
+ */
+static uint64_t integer_square_root(uint64_t n) {
+    if (n < 2) {
+        return n;
+    }
+
+    /** Newton's iteration, from above the root, decreases to it. */
+    uint64_t x = (uint64_t) 1 << ((65 - __builtin_clzll(n)) / 2);
+
+    for (;;) {
+        const uint64_t y = (x + (n / x)) / 2;
+
+        if (y >= x) {
+            return x;
+        }
+
+        x = y;
+    }
+}
+
+/**
+ * Append Sieving Prime
+ *
+ * @param[in,out] sieve The sieve.
+ * @param[in,out] capacity The number of primes the arrays of the sieve hold.
+ * @param[in] p The prime to append.
+ *
+ */
+static void append_sieving_prime(prime_sieve_t* sieve, size_t* capacity, uint64_t p) {
+    if (sieve->count == *capacity) {
+        *capacity = MAX(2 * *capacity, (size_t) 1024);
+
+        sieve->primes = realloc(sieve->primes, sizeof (uint32_t) * *capacity);
+        sieve->classes = realloc(sieve->classes, sizeof (unsigned char) * *capacity);
+
+        if ((sieve->primes == NULL) || (sieve->classes == NULL)) {
+            fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    sieve->primes[sieve->count] = (uint32_t) p;
+    sieve->classes[sieve->count] = wheel_positions[p % 30];
+    ++sieve->count;
+}
+
+/**
+ * Find Sieving Primes
+ *
+ * This function finds the primes from 7 up to the limit,
+ * the square root of the top of the range, which may be
+ * nearly 2^32. They are sieved from the odd numbers one
+ * segment at a time, itself no larger than the L1 segments
+ * of the main sieve, by the odd primes up to the square
+ * root of the limit, which are found with a plain sieve.
+ *
+ * @param[in,out] sieve The sieve.
+ * @param[in] limit The largest number to consider.
+ *
+ */
+static void find_sieving_primes(prime_sieve_t* sieve, uint64_t limit) {
+    const uint64_t root = integer_square_root(limit);
+
+    /** Odd number 2i + 1 is composite if composite[i] is set. */
+    unsigned char* composite = calloc((root / 2) + 1, sizeof (unsigned char));
+    uint32_t* seeds = malloc(sizeof (uint32_t) * ((root / 2) + 1));
+    uint64_t* multiples = malloc(sizeof (uint64_t) * ((root / 2) + 1));
+    unsigned char* segment = malloc(PRIME_SIEVE_SEGMENT_BYTES);
+
+    if ((composite == NULL) || (seeds == NULL) || (multiples == NULL) || (segment == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t seed_count = 0;
+
+    for (uint64_t p = 3; p <= root; p += 2) {
+        if (composite[p / 2]) {
+            continue;
+        }
+
+        for (uint64_t multiple = p * p; multiple <= root; multiple += 2 * p) {
+            composite[multiple / 2] = 1;
+        }
+
+        seeds[seed_count] = (uint32_t) p;
+        multiples[seed_count] = p * p;
+        ++seed_count;
+    }
+
+    size_t capacity = 0;
+
+    /** Each segment holds the odd numbers from start, one per byte. */
+    for (uint64_t start = 1; start <= limit; start += 2 * (uint64_t) PRIME_SIEVE_SEGMENT_BYTES) {
+        const uint64_t end = MIN(start + (2 * (uint64_t) PRIME_SIEVE_SEGMENT_BYTES) - 1, limit);
+
+        memset(segment, 0, PRIME_SIEVE_SEGMENT_BYTES);
+
+        for (size_t k = 0; k < seed_count; ++k) {
+            uint64_t multiple = multiples[k];
+
+            for (; multiple <= end; multiple += 2 * (uint64_t) seeds[k]) {
+                segment[(multiple - start) / 2] = 1;
+            }
+
+            multiples[k] = multiple;
+        }
+
+        for (uint64_t p = MAX(start, (uint64_t) 7); p <= end; p += 2) {
+            if (!segment[(p - start) / 2]) {
+                append_sieving_prime(sieve, &capacity, p);
+            }
+        }
+    }
+
+    free(composite);
+    free(seeds);
+    free(multiples);
+    free(segment);
+}
+
+/**
+ * Initialize Prime Sieve
+ *
+ * This function finds the sieving primes, and fills in the
+ * tables of the wheel.
+ *
+ * @param[out] sieve The sieve to initialize.
+ * @param[in] low The smallest number of the range.
+ * @param[in] high The largest number of the range.
+ *
+ */
+static void initialize_prime_sieve(prime_sieve_t* sieve, uint64_t low, uint64_t high) {
+    memset(sieve, 0, sizeof (prime_sieve_t));
+
+    sieve->low = low;
+    sieve->high = high;
+    sieve->threads = 1;
+
+    if (low > high) {
+        return;
+    }
+
+    sieve->first_byte = low / 30;
+    sieve->byte_count = (high / 30) - sieve->first_byte + 1;
+    sieve->block_count = (sieve->byte_count + PRIME_SIEVE_BLOCK_BYTES - 1) / PRIME_SIEVE_BLOCK_BYTES;
+
+    find_sieving_primes(sieve, integer_square_root(high));
+
+    for (unsigned int r = 0; r < 8; ++r) {
+        for (unsigned int i = 0; i < 8; ++i) {
+            const unsigned int residue = (wheel_residues[r] * wheel_residues[i]) % 30;
+
+            sieve->masks[r][i] = (unsigned char) ~(1u << wheel_positions[residue]);
+            sieve->carries[r][i] = (unsigned char) ((residue + (wheel_residues[r] * wheel_steps[i])) / 30);
+        }
+    }
+
+    for (unsigned int residue = 0, k = 0; residue < 30; ++residue) {
+        while (wheel_residues[k] < residue) {
+            ++k;
+        }
+
+        sieve->next_position[residue] = (unsigned char) k;
+    }
+
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    sieve->threads = (processors > 0) ? (size_t) processors : 1;
+    sieve->threads = MIN(sieve->threads, (size_t) PRIME_SIEVE_MAXIMUM_THREADS);
+    sieve->threads = MIN(sieve->threads, (size_t) MAX(sieve->block_count, (uint64_t) 1));
+}
+
+/**
+ * Release the sieving primes of a sieve.
+ *
+ */
+static void release_prime_sieve(prime_sieve_t* sieve) {
+    free(sieve->primes);
+    free(sieve->classes);
+}
+
+/**
+ * Create Prime Sieve Workers
+ *
+ * @param[in] sieve The sieve the workers work on.
+ *
+ * @returns One worker per thread of the sieve.
+ *
+ */
+static prime_sieve_worker_t* create_prime_sieve_workers(prime_sieve_t* sieve) {
+    prime_sieve_worker_t* workers = calloc(sieve->threads, sizeof (prime_sieve_worker_t));
+
+    if (workers == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t t = 0; t < sieve->threads; ++t) {
+        workers[t].sieve = sieve;
+        workers[t].buffer = malloc(PRIME_SIEVE_BLOCK_BYTES);
+        workers[t].offsets = malloc(sizeof (uint32_t) * MAX(sieve->count, (size_t) 1));
+        workers[t].positions = malloc(sizeof (unsigned char) * MAX(sieve->count, (size_t) 1));
+
+        if ((workers[t].buffer == NULL) || (workers[t].offsets == NULL) || (workers[t].positions == NULL)) {
+            fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return workers;
+}
+
+/**
+ * Free Prime Sieve Workers
+ *
+ */
+static void free_prime_sieve_workers(prime_sieve_worker_t* workers, size_t count) {
+    for (size_t t = 0; t < count; ++t) {
+        free(workers[t].buffer);
+        free(workers[t].offsets);
+        free(workers[t].positions);
+    }
+
+    free(workers);
+}
+
+/**
+ * Sieve Prime Block
+ *
+ * This function sieves the worker's block, leaving a bit set
+ * for every prime of the range it covers, other than 2, 3,
+ * and 5.
+ *
+ * Each sieving prime p first finds its smallest multiple in
+ * the block, pq with q coprime to 30 and no less than p, and
+ * then crosses off its multiples one segment at a time,
+ * picking up where it left off in the previous segment.
+ * Only the primes whose square does not exceed the last
+ * number of the block, or of the range if that comes first,
+ * can cross anything off in it.
+ *
+ * @param[in,out] worker The worker whose block to sieve.
+ *
+ */
+static void sieve_prime_block(prime_sieve_worker_t* worker) {
+    const prime_sieve_t* sieve = worker->sieve;
+
+    const uint64_t begin = sieve->first_byte + (worker->block * PRIME_SIEVE_BLOCK_BYTES);
+    const size_t length = (size_t) MIN((uint64_t) PRIME_SIEVE_BLOCK_BYTES, sieve->first_byte + sieve->byte_count - begin);
+
+    unsigned char* buffer = worker->buffer;
+
+    memset(buffer, 0xFF, length);
+
+    const uint64_t base = 30 * begin;
+    const uint64_t span = (30 * (uint64_t) length) - 1;
+
+    /** The last number of the block, which may not be representable in the last block of the range. */
+    const uint64_t top = (span > UINT64_MAX - base) ? UINT64_MAX : base + span;
+    const uint64_t last = MIN(top, sieve->high);
+
+    size_t count = 0;
+
+    while ((count < sieve->count) && ((uint64_t) sieve->primes[count] * sieve->primes[count] <= last)) {
+        ++count;
+    }
+
+    for (size_t k = 0; k < count; ++k) {
+        const uint64_t p = sieve->primes[k];
+
+        uint64_t q = MAX(p, (base / p) + ((base % p) != 0));
+        uint64_t multiple;
+
+        const unsigned int position = sieve->next_position[q % 30];
+
+        q = ((q / 30) * 30) + wheel_residues[position];
+
+        if (__builtin_mul_overflow(q, p, &multiple) || ((multiple / 30) - begin >= length)) {
+            worker->offsets[k] = (uint32_t) length;
+        } else {
+            worker->offsets[k] = (uint32_t) ((multiple / 30) - begin);
+        }
+
+        worker->positions[k] = (unsigned char) position;
+    }
+
+    for (size_t end = MIN((size_t) PRIME_SIEVE_SEGMENT_BYTES, length); ; end = MIN(end + PRIME_SIEVE_SEGMENT_BYTES, length)) {
+        for (size_t k = 0; k < count; ++k) {
+            const uint32_t quotient = sieve->primes[k] / 30;
+            const unsigned char* masks = sieve->masks[sieve->classes[k]];
+            const unsigned char* carries = sieve->carries[sieve->classes[k]];
+
+            uint32_t offset = worker->offsets[k];
+            unsigned int i = worker->positions[k];
+
+            while (offset < end) {
+                buffer[offset] &= masks[i];
+                offset += (quotient * wheel_steps[i]) + carries[i];
+                i = (i + 1) & 7;
+            }
+
+            worker->offsets[k] = offset;
+            worker->positions[k] = (unsigned char) i;
+        }
+
+        if (end == length) {
+            break;
+        }
+    }
+
+    /** One is not a prime. */
+    if (begin == 0) {
+        buffer[0] &= (unsigned char) ~1u;
+    }
+
+    for (unsigned int k = 0; k < 8; ++k) {
+        if ((begin == sieve->first_byte) && (base + wheel_residues[k] < sieve->low)) {
+            buffer[0] &= (unsigned char) ~(1u << k);
+        }
+
+        if ((begin + length == sieve->first_byte + sieve->byte_count) && (wheel_residues[k] > sieve->high - (30 * (begin + length - 1)))) {
+            buffer[length - 1] &= (unsigned char) ~(1u << k);
+        }
+    }
+
+    worker->length = length;
+}
+
+/**
+ * Count Sieved Primes
+ *
+ * @param[in] buffer A sieved block.
+ * @param[in] length The length of the block.
+ *
+ * @returns The number of primes left in the block.
+ *
+ */
+static uint64_t count_sieved_primes(const unsigned char* buffer, size_t length) {
+    uint64_t count = 0;
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+
+        memcpy(&word, buffer + i, sizeof (word));
+        count += (uint64_t) __builtin_popcountll(word);
+    }
+
+    for (; i < length; ++i) {
+        count += (uint64_t) __builtin_popcount(buffer[i]);
+    }
+
+    return count;
+}
+
+/**
+ * Run Prime Sieve Worker
+ *
+ * @param[in,out] argument The worker, with its block set.
+ *
+ * @returns NULL.
+ *
+ */
+static void* run_prime_sieve_worker(void* argument) {
+    sieve_prime_block(argument);
+
+    return NULL;
+}
+
+/**
+ * Sieve Prime Round
+ *
+ * This function sieves the next consecutive blocks of the
+ * range, one per worker, in parallel, the calling thread
+ * sieving the first of them. If a thread cannot be started,
+ * the calling thread sieves its block itself.
+ *
+ * @param[in,out] sieve The sieve.
+ * @param[in,out] workers The workers.
+ *
+ * @returns The number of blocks sieved, which are held by
+ * the first as many workers, in order.
+ *
+ */
+static size_t sieve_prime_round(prime_sieve_t* sieve, prime_sieve_worker_t* workers) {
+    const size_t count = (size_t) MIN((uint64_t) sieve->threads, sieve->block_count - sieve->next_block);
+
+    int started[PRIME_SIEVE_MAXIMUM_THREADS] = { 0 };
+
+    for (size_t t = 0; t < count; ++t) {
+        workers[t].block = sieve->next_block + t;
+    }
+
+    for (size_t t = 1; t < count; ++t) {
+        started[t] = (pthread_create(&workers[t].thread, NULL, run_prime_sieve_worker, &workers[t]) == 0);
+    }
+
+    if (count > 0) {
+        sieve_prime_block(&workers[0]);
+    }
+
+    for (size_t t = 1; t < count; ++t) {
+        if (started[t]) {
+            pthread_join(workers[t].thread, NULL);
+        } else {
+            sieve_prime_block(&workers[t]);
+        }
+    }
+
+    sieve->next_block += count;
+
+    return count;
+}
+
+/**
+ * Count Wheel Primes
+ *
+ * @param[in] low The smallest number of the range.
+ * @param[in] high The largest number of the range.
+ *
+ * @returns The number of the primes 2, 3, and 5 in the range.
+ *
+ */
+static uint64_t count_wheel_primes(uint64_t low, uint64_t high) {
+    uint64_t count = 0;
+
+    for (size_t i = 0; i < 3; ++i) {
+        count += (low <= wheel_primes[i]) && (wheel_primes[i] <= high);
+    }
+
+    return count;
+}
+
+/**
+ * Prime Iterator
+ *
+ * An iterator sieves as many consecutive blocks as it has
+ * threads at a time, and then hands out the primes in them
+ * in order, so its memory is bounded by the size of a block
+ * per thread, however large the range.
+ *
+ */
+struct prime_iterator {
+    prime_sieve_t sieve;
+    prime_sieve_worker_t* workers;
+    size_t blocks;
+    size_t current;
+    size_t offset;
+    unsigned int bits;
+    uint64_t base;
+    size_t wheel_primes;
+};
+
+/**
+ * Create Prime Iterator
+ *
+ * @param[in] low The smallest number of the range.
+ * @param[in] high The largest number of the range.
+ *
+ * @returns Pointer to the iterator, which must be released
+ * using free_prime_iterator().
+ *
+ */
+prime_iterator_t* create_prime_iterator(uint64_t low, uint64_t high) {
+    prime_iterator_t* iterator = calloc(1, sizeof (prime_iterator_t));
+
+    if (iterator == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    initialize_prime_sieve(&iterator->sieve, low, high);
+
+    iterator->workers = create_prime_sieve_workers(&iterator->sieve);
+
+    return iterator;
+}
+
+/**
+ * Get Next Prime
+ *
+ * @param[in,out] iterator The iterator.
+ * @param[out] prime The next prime of the range.
+ *
+ * @returns True if there was another prime in the range,
+ * or false once the range is exhausted.
+ *
+ */
+bool_t get_next_prime(prime_iterator_t* iterator, uint64_t* prime) {
+    const prime_sieve_t* sieve = &iterator->sieve;
+
+    while (iterator->wheel_primes < 3) {
+        const uint64_t p = wheel_primes[iterator->wheel_primes++];
+
+        if ((sieve->low <= p) && (p <= sieve->high)) {
+            *prime = p;
+            return true;
+        }
+    }
+
+    for (;;) {
+        if (iterator->bits != 0) {
+            const unsigned int k = (unsigned int) __builtin_ctz(iterator->bits);
+
+            iterator->bits &= iterator->bits - 1;
+            *prime = iterator->base + wheel_residues[k];
+
+            return true;
+        }
+
+        while (iterator->current < iterator->blocks) {
+            const prime_sieve_worker_t* worker = &iterator->workers[iterator->current];
+
+            while ((iterator->offset < worker->length) && (worker->buffer[iterator->offset] == 0)) {
+                ++iterator->offset;
+            }
+
+            if (iterator->offset < worker->length) {
+                const uint64_t byte = sieve->first_byte + (worker->block * PRIME_SIEVE_BLOCK_BYTES) + iterator->offset;
+
+                iterator->bits = worker->buffer[iterator->offset++];
+                iterator->base = 30 * byte;
+
+                break;
+            }
+
+            ++iterator->current;
+            iterator->offset = 0;
+        }
+
+        if (iterator->bits != 0) {
+            continue;
+        }
+
+        if (sieve->next_block >= sieve->block_count) {
+            return false;
+        }
+
+        iterator->blocks = sieve_prime_round(&iterator->sieve, iterator->workers);
+        iterator->current = 0;
+        iterator->offset = 0;
+    }
+}
+
+/**
+ * Free Prime Iterator
+ *
+ * @param[in] iterator The iterator to free. May be NULL.
+ *
+ */
+void free_prime_iterator(prime_iterator_t* iterator) {
+    if (iterator == NULL) {
+        return;
+    }
+
+    free_prime_sieve_workers(iterator->workers, iterator->sieve.threads);
+    release_prime_sieve(&iterator->sieve);
+    free(iterator);
+}
+
+/**
+ * For Each Prime
+ *
+ * @param[in] low The smallest number of the range.
+ * @param[in] high The largest number of the range.
+ * @param[in] callback The function to report primes to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns The number of primes reported to the callback.
+ *
+ */
+uint64_t for_each_prime(uint64_t low, uint64_t high, prime_callback_t callback, void* context) {
+    prime_iterator_t* iterator = create_prime_iterator(low, high);
+
+    uint64_t count = 0;
+    uint64_t prime;
+
+    while (get_next_prime(iterator, &prime)) {
+        ++count;
+
+        if (callback(prime, context)) {
+            break;
+        }
+    }
+
+    free_prime_iterator(iterator);
+
+    return count;
+}
+
+/**
+ * Run Prime Count Worker
+ *
+ * Each worker repeatedly claims the next block of the range
+ * until none are left, counting the primes in each.
+ *
+ * @param[in,out] argument The worker.
+ *
+ * @returns NULL.
+ *
+ */
+static void* run_prime_count_worker(void* argument) {
+    prime_sieve_worker_t* worker = argument;
+
+    for (;;) {
+        worker->block = __atomic_fetch_add(&worker->sieve->next_block, 1, __ATOMIC_RELAXED);
+
+        if (worker->block >= worker->sieve->block_count) {
+            break;
+        }
+
+        sieve_prime_block(worker);
+
+        worker->primes += count_sieved_primes(worker->buffer, worker->length);
+    }
+
+    return NULL;
+}
+
+/**
+ * Prime Count
+ *
+ * The blocks of the range are counted in no particular
+ * order, each thread claiming the next block as soon as it
+ * is done with the last. If a thread cannot be started, the
+ * others simply take up its share of the blocks.
+ *
+ * @param[in] low The smallest number of the range.
+ * @param[in] high The largest number of the range.
+ *
+ * @returns The number of primes p with low <= p <= high.
+ *
+ */
+uint64_t prime_count(uint64_t low, uint64_t high) {
+    prime_sieve_t sieve;
+
+    initialize_prime_sieve(&sieve, low, high);
+
+    prime_sieve_worker_t* workers = create_prime_sieve_workers(&sieve);
+
+    int started[PRIME_SIEVE_MAXIMUM_THREADS] = { 0 };
+
+    for (size_t t = 1; t < sieve.threads; ++t) {
+        started[t] = (pthread_create(&workers[t].thread, NULL, run_prime_count_worker, &workers[t]) == 0);
+    }
+
+    run_prime_count_worker(&workers[0]);
+
+    uint64_t count = workers[0].primes;
+
+    for (size_t t = 1; t < sieve.threads; ++t) {
+        if (started[t]) {
+            pthread_join(workers[t].thread, NULL);
+        }
+
+        count += workers[t].primes;
+    }
+
+    free_prime_sieve_workers(workers, sieve.threads);
+    release_prime_sieve(&sieve);
+
+    return (low <= high) ? count + count_wheel_primes(low, high) : 0;
+}
+
+/**
+ * Nth Prime Bound
+ *
+ * The nth prime is less than n (ln n + ln ln n) for n >= 6,
+ * by Rosser's theorem. Writing b for the bit length of n,
+ * and c for that of b, ln n < b ln 2 and ln ln n < c ln 2,
+ * which gives a bound without floating point arithmetic.
+ *
+ * @param[in] n The index of the prime, at least 4.
+ *
+ * @returns An upper bound on the nth prime, saturated at
+ * UINT64_MAX.
+ *
+ * @cite rosser_nth_1939
+ *
+ */
+static uint64_t nth_prime_bound(uint64_t n) {
+    const unsigned int b = 64 - (unsigned int) __builtin_clzll(n);
+    const unsigned int c = 32 - (unsigned int) __builtin_clz(b);
+
+    const unsigned __int128 bound = (((unsigned __int128) n * (b + c) * 6932) / 10000) + 30;
+
+    return (bound > UINT64_MAX) ? UINT64_MAX : (uint64_t) bound;
+}
+
+/**
+ * Nth Prime
+ *
+ * The primes are counted a round of blocks at a time, the
+ * blocks of a round being sieved in parallel, until the
+ * block holding the nth prime is reached, which is then
+ * searched for it bit by bit. Only the bound on the nth
+ * prime is used to choose the sieving primes; the count
+ * stops as soon as the prime is found.
+ *
+ * @param[in] n The index of the prime, starting from 1.
+ *
+ * @returns The nth prime, or zero if n is zero or the nth
+ * prime does not fit in 64 bits.
+ *
+ */
+uint64_t nth_prime(uint64_t n) {
+    if (n == 0) {
+        return 0;
+    }
+
+    if (n <= 3) {
+        return wheel_primes[n - 1];
+    }
+
+    prime_sieve_t sieve;
+
+    initialize_prime_sieve(&sieve, 0, nth_prime_bound(n));
+
+    prime_sieve_worker_t* workers = create_prime_sieve_workers(&sieve);
+
+    uint64_t remaining = n - 3;
+    uint64_t prime = 0;
+
+    while ((prime == 0) && (sieve.next_block < sieve.block_count)) {
+        const size_t blocks = sieve_prime_round(&sieve, workers);
+
+        for (size_t t = 0; (t < blocks) && (prime == 0); ++t) {
+            const uint64_t count = count_sieved_primes(workers[t].buffer, workers[t].length);
+
+            if (count < remaining) {
+                remaining -= count;
+                continue;
+            }
+
+            const uint64_t begin = sieve.first_byte + (workers[t].block * PRIME_SIEVE_BLOCK_BYTES);
+
+            for (size_t i = 0; i < workers[t].length; ++i) {
+                const unsigned int bits = workers[t].buffer[i];
+                const uint64_t population = (uint64_t) __builtin_popcount(bits);
+
+                if (population < remaining) {
+                    remaining -= population;
+                    continue;
+                }
+
+                unsigned int rest = bits;
+
+                while (--remaining > 0) {
+                    rest &= rest - 1;
+                }
+
+                prime = (30 * (begin + i)) + wheel_residues[__builtin_ctz(rest)];
+                break;
+            }
+        }
+    }
+
+    free_prime_sieve_workers(workers, sieve.threads);
+    release_prime_sieve(&sieve);
+
+    return prime;
+}
@@ -0,0 +1,761 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ * 
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ * 
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xstrings.h"
+
+/**
+ * Benchmark Bytes
+ *
+ * The number of bytes each timed loop processes in total,
+ * repeating the same call as many times as that takes, so
+ * that every measurement runs long enough to be stable
+ * whatever the size of its input.
+ *
+ * @def BENCHMARK_BYTES
+ *
+ */
+#ifndef BENCHMARK_BYTES
+#define BENCHMARK_BYTES (256 * 1024 * 1024)
+#endif
+
+/**
+ * Benchmark Minimum Iterations
+ *
+ * @def BENCHMARK_MINIMUM_ITERATIONS
+ *
+ */
+#ifndef BENCHMARK_MINIMUM_ITERATIONS
+#define BENCHMARK_MINIMUM_ITERATIONS 64
+#endif
+
+/**
+ * String Length Function
+ *
+ * @typedef string_length_function_t
+ *
+ */
+typedef size_t (*string_length_function_t)(const char*);
+
+/**
+ * The C library's strlen, called through a volatile pointer
+ * so that the compiler can neither inline it nor hoist it
+ * out of the timed loop.
+ *
+ */
+static size_t (*volatile library_strlen)(const char*) = strlen;
+
+/**
+ * The public string_length(), called the same way.
+ *
+ */
+static size_t (*volatile xlibs_string_length)(const char*) = string_length;
+
+/**
+ * Get Time
+ *
+ * @returns The monotonic clock, in seconds.
+ *
+ */
+static double get_time(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double) now.tv_sec + ((double) now.tv_nsec * 1e-9);
+}
+
+/**
+ * Count Benchmark Iterations
+ *
+ * @param[in] bytes The number of bytes a single call processes.
+ *
+ * @returns The number of times to repeat the call.
+ *
+ */
+static size_t count_benchmark_iterations(size_t bytes) {
+    const size_t iterations = BENCHMARK_BYTES / ((bytes > 0) ? bytes : 1);
+
+    return (iterations > BENCHMARK_MINIMUM_ITERATIONS) ? iterations : BENCHMARK_MINIMUM_ITERATIONS;
+}
+
+/**
+ * Allocate a buffer aligned to a page.
+ *
+ */
+static char* allocate_buffer(size_t size) {
+    void* buffer = NULL;
+
+    if (posix_memalign(&buffer, 4096, size) != 0) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    return buffer;
+}
+
+/**
+ * Next Random Number
+ *
+ * A xorshift generator, so that every run benchmarks the
+ * same inputs.
+ *
+ */
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+
+    return *state;
+}
+
+/**
+ * Search Algorithm Names
+ *
+ * Every string searching algorithm, in the order of the
+ * enum, with the name it is reported under.
+ *
+ */
+static const struct {
+    string_search_algorithm_t algorithm;
+    const char* name;
+} search_algorithms[] = {
+    { NAIVE_STRING_SEARCH, "naive" },
+    { RABIN_KARP_STRING_SEARCH, "rabin-karp" },
+    { FINITE_AUTOMATON_STRING_SEARCH, "finite automaton" },
+    { KNUTH_MORRIS_PRATT_STRING_SEARCH, "knuth-morris-pratt" },
+    { GENERIC_SIMD_STRING_SEARCH, "generic simd" },
+    { TWO_WAY_STRING_SEARCH, "two-way" },
+    { BOYER_MOORE_STRING_SEARCH, "boyer-moore" },
+    { HORSPOOL_STRING_SEARCH, "horspool" }
+};
+
+/**
+ * The number of string searching algorithms.
+ *
+ */
+#define SEARCH_ALGORITHM_COUNT (sizeof (search_algorithms) / sizeof (search_algorithms[0]))
+
+/**
+ * Check String Length Variant
+ *
+ * This function compares an implementation of
+ * string_length() with strlen for every length up to a few
+ * vectors, starting at every offset from a 64-byte boundary,
+ * and then for strings ending on the last byte of a page
+ * followed by an inaccessible one, where reading a single
+ * vector too far would fault.
+ *
+ * @param[in] name The name of the implementation.
+ * @param[in] function The implementation to check.
+ *
+ * @returns The number of mismatches.
+ *
+ */
+static size_t check_string_length_variant(const char* name, string_length_function_t function) {
+    size_t failures = 0;
+
+    char* buffer = allocate_buffer(512);
+
+    for (size_t alignment = 0; alignment < 64; ++alignment) {
+        for (size_t length = 0; length < 320; ++length) {
+            memset(buffer, 'x', 512);
+            buffer[alignment + length] = '\0';
+
+            if (function(buffer + alignment) != length) {
+                ++failures;
+            }
+        }
+    }
+
+    free(buffer);
+
+    const long page_size = sysconf(_SC_PAGESIZE);
+
+    char* pages = mmap(NULL, (size_t) (2 * page_size), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if ((pages == MAP_FAILED) || (mprotect(pages + page_size, (size_t) page_size, PROT_NONE) != 0)) {
+        fprintf(stderr, "[Error] %s\n", "Could not map a guard page");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(pages, 'x', (size_t) page_size);
+    pages[page_size - 1] = '\0';
+
+    for (size_t length = 0; length < 320; ++length) {
+        if (function(pages + page_size - 1 - length) != length) {
+            ++failures;
+        }
+    }
+
+    munmap(pages, (size_t) (2 * page_size));
+
+    printf("%-24s %s\n", name, (failures == 0) ? "ok" : "FAILED");
+
+    return failures;
+}
+
+/**
+ * Time String Length
+ *
+ * @param[in] function The implementation to time.
+ * @param[in] string The string to measure.
+ * @param[in] length The length of the string.
+ *
+ * @returns The throughput, in gigabytes per second.
+ *
+ */
+static double time_string_length(string_length_function_t function, const char* string, size_t length) {
+    const size_t iterations = count_benchmark_iterations(length);
+
+    size_t total = 0;
+
+    const double start = get_time();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        total += function(string);
+    }
+
+    const double elapsed = get_time() - start;
+
+    if (total != iterations * length) {
+        fprintf(stderr, "[Error] %s\n", "String length mismatch");
+        exit(EXIT_FAILURE);
+    }
+
+    return ((double) total / elapsed) * 1e-9;
+}
+
+/**
+ * Benchmark String Length
+ *
+ * This function checks every vectorized implementation of
+ * string_length() the host supports, and then times the
+ * selected one against the C library's strlen for strings
+ * from one byte to one mebibyte.
+ *
+ * @returns The number of mismatches found.
+ *
+ */
+static size_t benchmark_string_length(void) {
+    size_t failures = 0;
+
+    printf("string_length\n\n");
+
+#if defined(__x86_64__) && defined(__ELF__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("sse2")) {
+        failures += check_string_length_variant("string_length_sse2", string_length_sse2);
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        failures += check_string_length_variant("string_length_avx2", string_length_avx2);
+    }
+
+    if (__builtin_cpu_supports("avx512bw")) {
+        failures += check_string_length_variant("string_length_avx512bw", string_length_avx512bw);
+    }
+#endif
+
+    failures += check_string_length_variant("string_length", xlibs_string_length);
+
+    printf("\n%10s %14s %14s\n", "length", "strlen GB/s", "xlibs GB/s");
+
+    const size_t maximum = 1024 * 1024;
+
+    char* buffer = allocate_buffer(maximum + 1);
+
+    memset(buffer, 'x', maximum);
+
+    for (size_t length = 1; length <= maximum; length *= 4) {
+        buffer[length] = '\0';
+
+        const double library = time_string_length(library_strlen, buffer, length);
+        const double xlibs = time_string_length(xlibs_string_length, buffer, length);
+
+        printf("%10zu %14.2f %14.2f\n", length, library, xlibs);
+
+        buffer[length] = 'x';
+    }
+
+    free(buffer);
+
+    printf("\n");
+
+    return failures;
+}
+
+/**
+ * Log Line Count
+ *
+ * The number of log lines the compiled search benchmark
+ * searches.
+ *
+ * @def LOG_LINE_COUNT
+ *
+ */
+#ifndef LOG_LINE_COUNT
+#define LOG_LINE_COUNT (1 << 17)
+#endif
+
+/**
+ * Log Line Length
+ *
+ * @def LOG_LINE_LENGTH
+ *
+ */
+#ifndef LOG_LINE_LENGTH
+#define LOG_LINE_LENGTH 120
+#endif
+
+/**
+ * Generate Log Lines
+ *
+ * This function fills a buffer with null-terminated lines
+ * of lowercase words, one in a hundred of which contains
+ * the needle.
+ *
+ * @param[in] needle The needle to plant in some of the lines.
+ *
+ * @returns The buffer, of LOG_LINE_COUNT lines of
+ * LOG_LINE_LENGTH bytes each, terminator included.
+ *
+ */
+static char* generate_log_lines(const char* needle) {
+    char* lines = allocate_buffer((size_t) LOG_LINE_COUNT * LOG_LINE_LENGTH);
+
+    const size_t needle_length = strlen(needle);
+
+    uint64_t state = 0x9E3779B97F4A7C15;
+
+    for (size_t i = 0; i < LOG_LINE_COUNT; ++i) {
+        char* line = lines + (i * LOG_LINE_LENGTH);
+
+        for (size_t j = 0; j < LOG_LINE_LENGTH - 1; ++j) {
+            const uint64_t r = next_random(&state) % 32;
+
+            line[j] = (r < 26) ? (char) ('a' + r) : ' ';
+        }
+
+        line[LOG_LINE_LENGTH - 1] = '\0';
+
+        if (next_random(&state) % 100 == 0) {
+            memcpy(line + (next_random(&state) % (LOG_LINE_LENGTH - needle_length)), needle, needle_length);
+        }
+    }
+
+    return lines;
+}
+
+/**
+ * Benchmark Compiled Search
+ *
+ * This function searches a set of log lines for the same
+ * needle with every algorithm, once by calling
+ * find_substring() on each line, which preprocesses the
+ * needle every time, and once with a pattern compiled up
+ * front, checking that both find the needle on the same
+ * lines as strstr.
+ *
+ * @returns The number of mismatches found.
+ *
+ */
+static size_t benchmark_compiled_search(void) {
+    static const char* needles[] = {
+        "error",
+        "connection reset by peer"
+    };
+
+    size_t failures = 0;
+
+    printf("compiled search (%d lines of %d bytes)\n\n", LOG_LINE_COUNT, LOG_LINE_LENGTH);
+
+    for (size_t n = 0; n < sizeof (needles) / sizeof (needles[0]); ++n) {
+        const char* needle = needles[n];
+
+        char* lines = generate_log_lines(needle);
+
+        size_t expected = 0;
+
+        for (size_t i = 0; i < LOG_LINE_COUNT; ++i) {
+            expected += (strstr(lines + (i * LOG_LINE_LENGTH), needle) != NULL);
+        }
+
+        printf("needle \"%s\", %zu matching lines\n\n", needle, expected);
+        printf("%-20s %16s %16s %10s\n", "algorithm", "per-call ns/line", "compiled ns/line", "speedup");
+
+        for (size_t a = 0; a < SEARCH_ALGORITHM_COUNT; ++a) {
+            size_t per_call_matches = 0;
+            size_t compiled_matches = 0;
+
+            double start = get_time();
+
+            for (size_t i = 0; i < LOG_LINE_COUNT; ++i) {
+                per_call_matches += (find_substring(search_algorithms[a].algorithm, needle, lines + (i * LOG_LINE_LENGTH)) != NULL);
+            }
+
+            const double per_call = get_time() - start;
+
+            start = get_time();
+
+            search_pattern_t* pattern = compile_search_pattern(search_algorithms[a].algorithm, needle);
+
+            for (size_t i = 0; i < LOG_LINE_COUNT; ++i) {
+                compiled_matches += (find_compiled_pattern(pattern, lines + (i * LOG_LINE_LENGTH)) != NULL);
+            }
+
+            free_search_pattern(pattern);
+
+            const double compiled = get_time() - start;
+
+            const int ok = (per_call_matches == expected) && (compiled_matches == expected);
+
+            failures += !ok;
+
+            printf("%-20s %16.1f %16.1f %9.2fx%s\n", search_algorithms[a].name, (per_call * 1e9) / LOG_LINE_COUNT, (compiled * 1e9) / LOG_LINE_COUNT, per_call / compiled, ok ? "" : "  FAILED");
+        }
+
+        printf("\n");
+
+        free(lines);
+    }
+
+    return failures;
+}
+
+/**
+ * Long Needle Haystack Bytes
+ *
+ * The size of the haystack the long needle benchmark
+ * searches.
+ *
+ * @def LONG_NEEDLE_HAYSTACK_BYTES
+ *
+ */
+#ifndef LONG_NEEDLE_HAYSTACK_BYTES
+#define LONG_NEEDLE_HAYSTACK_BYTES (64 << 20)
+#endif
+
+/**
+ * Benchmark Long Needles
+ *
+ * This function searches a large haystack of lowercase
+ * text for needles of increasing length planted only at
+ * its very end, so that every algorithm scans all of it,
+ * and reports the throughput of the skip-based algorithms
+ * against Knuth-Morris-Pratt and the naive search.
+ *
+ * @returns The number of searches that missed the needle.
+ *
+ */
+static size_t benchmark_long_needles(void) {
+    static const string_search_algorithm_t algorithms[] = {
+        NAIVE_STRING_SEARCH,
+        KNUTH_MORRIS_PRATT_STRING_SEARCH,
+        BOYER_MOORE_STRING_SEARCH,
+        HORSPOOL_STRING_SEARCH
+    };
+
+    static const size_t needle_lengths[] = { 16, 64, 256, 1024, 4096 };
+
+    const size_t algorithm_count = sizeof (algorithms) / sizeof (algorithms[0]);
+
+    char* haystack = allocate_buffer(LONG_NEEDLE_HAYSTACK_BYTES);
+
+    uint64_t state = 0xD1B54A32D192ED03;
+
+    for (size_t i = 0; i < LONG_NEEDLE_HAYSTACK_BYTES; ++i) {
+        haystack[i] = (char) ('a' + (next_random(&state) % 26));
+    }
+
+    size_t failures = 0;
+
+    printf("long needles (%d MiB haystack, GB/s)\n\n", LONG_NEEDLE_HAYSTACK_BYTES >> 20);
+    printf("%10s", "length");
+
+    for (size_t a = 0; a < algorithm_count; ++a) {
+        printf(" %20s", search_algorithms[algorithms[a]].name);
+    }
+
+    printf("\n");
+
+    for (size_t n = 0; n < sizeof (needle_lengths) / sizeof (needle_lengths[0]); ++n) {
+        const size_t needle_length = needle_lengths[n];
+        const size_t position = LONG_NEEDLE_HAYSTACK_BYTES - needle_length;
+
+        /**
+         * Take the needle from a different stream than the
+         * haystack, so it occurs only where it is planted.
+         *
+         */
+        char* needle = malloc(needle_length);
+
+        if (needle == NULL) {
+            fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+            exit(EXIT_FAILURE);
+        }
+
+        uint64_t needle_state = 0x2545F4914F6CDD1D + needle_length;
+
+        for (size_t i = 0; i < needle_length; ++i) {
+            needle[i] = (char) ('a' + (next_random(&needle_state) % 26));
+        }
+
+        char saved[4096];
+
+        memcpy(saved, haystack + position, needle_length);
+        memcpy(haystack + position, needle, needle_length);
+
+        printf("%10zu", needle_length);
+
+        for (size_t a = 0; a < algorithm_count; ++a) {
+            search_pattern_t* pattern = compile_search_pattern_n(algorithms[a], needle, needle_length);
+
+            const double start = get_time();
+
+            const char* match = find_compiled_pattern_n(pattern, haystack, LONG_NEEDLE_HAYSTACK_BYTES);
+
+            const double elapsed = get_time() - start;
+
+            free_search_pattern(pattern);
+
+            const int ok = (match == haystack + position);
+
+            failures += !ok;
+
+            printf(" %20.2f%s", LONG_NEEDLE_HAYSTACK_BYTES / elapsed / 1e9, ok ? "" : " FAILED");
+        }
+
+        printf("\n");
+
+        memcpy(haystack + position, saved, needle_length);
+
+        free(needle);
+    }
+
+    printf("\n");
+
+    free(haystack);
+
+    return failures;
+}
+
+/**
+ * Pattern Set Needles
+ *
+ * The number of needles the pattern set benchmark compiles,
+ * enough for its automaton to take the double-array layout.
+ *
+ * @def PATTERN_SET_NEEDLES
+ *
+ */
+#ifndef PATTERN_SET_NEEDLES
+#define PATTERN_SET_NEEDLES 65536
+#endif
+
+/**
+ * Pattern Set Build Budget
+ *
+ * The number of seconds compiling the pattern set may take
+ * before the benchmark counts it as a failure. A build that
+ * grows quadratically with the number of needles takes
+ * minutes here.
+ *
+ * @def PATTERN_SET_BUILD_BUDGET
+ *
+ */
+#ifndef PATTERN_SET_BUILD_BUDGET
+#define PATTERN_SET_BUILD_BUDGET 5.0
+#endif
+
+/**
+ * Pattern Set Match
+ *
+ * The needles of the set and the haystack they were planted
+ * in, along with the number of planted needles found and
+ * of matches that are not occurrences of their needle.
+ *
+ */
+typedef struct {
+    const char* const* needles;
+    const size_t* lengths;
+    const char* haystack;
+    const size_t* planted;
+    size_t found;
+    size_t wrong;
+} pattern_set_match_t;
+
+/**
+ * Check Pattern Set Match
+ *
+ */
+static int check_pattern_set_match(size_t needle_index, size_t offset, void* context) {
+    pattern_set_match_t* match = context;
+
+    if (memcmp(match->haystack + offset, match->needles[needle_index], match->lengths[needle_index]) != 0) {
+        ++match->wrong;
+    }
+
+    match->found += (match->planted[needle_index] == offset);
+
+    return 0;
+}
+
+/**
+ * Benchmark Pattern Set Build
+ *
+ * This function compiles a large set of lowercase needles
+ * into an Aho-Corasick automaton, timing the build against
+ * a fixed budget, and then searches a haystack made of
+ * every needle in turn, checking that each of them is found
+ * where it was planted.
+ *
+ * @returns The number of failed checks.
+ *
+ */
+static size_t benchmark_pattern_set_build(void) {
+    char** needles = malloc(sizeof (char*) * PATTERN_SET_NEEDLES);
+    size_t* lengths = malloc(sizeof (size_t) * PATTERN_SET_NEEDLES);
+    size_t* planted = malloc(sizeof (size_t) * PATTERN_SET_NEEDLES);
+
+    if ((needles == NULL) || (lengths == NULL) || (planted == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t state = 0xA0761D6478BD642F;
+
+    size_t haystack_length = 0;
+
+    for (size_t i = 0; i < PATTERN_SET_NEEDLES; ++i) {
+        lengths[i] = 4 + (next_random(&state) % 12);
+        needles[i] = malloc(lengths[i]);
+
+        if (needles[i] == NULL) {
+            fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+            exit(EXIT_FAILURE);
+        }
+
+        for (size_t j = 0; j < lengths[i]; ++j) {
+            needles[i][j] = (char) ('a' + (next_random(&state) % 26));
+        }
+
+        planted[i] = haystack_length;
+        haystack_length += lengths[i];
+    }
+
+    char* haystack = malloc(haystack_length);
+
+    if (haystack == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < PATTERN_SET_NEEDLES; ++i) {
+        memcpy(haystack + planted[i], needles[i], lengths[i]);
+    }
+
+    double start = get_time();
+
+    search_pattern_set_t* set = compile_search_pattern_set_n(KNUTH_MORRIS_PRATT_STRING_SEARCH, (const char* const*) needles, lengths, PATTERN_SET_NEEDLES);
+
+    const double build = get_time() - start;
+
+    pattern_set_match_t match = { (const char* const*) needles, lengths, haystack, planted, 0, 0 };
+
+    start = get_time();
+
+    const size_t matches = for_each_pattern_set_match_n(set, haystack, haystack_length, check_pattern_set_match, &match);
+
+    const double search = get_time() - start;
+
+    free_search_pattern_set(set);
+
+    const int built = (build <= PATTERN_SET_BUILD_BUDGET);
+    const int found = (match.found == PATTERN_SET_NEEDLES) && (match.wrong == 0);
+
+    printf("pattern set build (%d needles)\n\n", PATTERN_SET_NEEDLES);
+    printf("%-24s %10.3f s%s\n", "build", build, built ? "" : "  FAILED");
+    printf("%-24s %10.2f GB/s, %zu matches%s\n", "search", haystack_length / search / 1e9, matches, found ? "" : "  FAILED");
+    printf("\n");
+
+    for (size_t i = 0; i < PATTERN_SET_NEEDLES; ++i) {
+        free(needles[i]);
+    }
+
+    free(needles);
+    free(lengths);
+    free(planted);
+    free(haystack);
+
+    return (size_t) !built + (size_t) !found;
+}
+
+/**
+ * Benchmark
+ *
+ * A benchmark, run when its name is given on the command
+ * line, or when none is.
+ *
+ */
+typedef struct {
+    const char* name;
+    size_t (*run)(void);
+} benchmark_t;
+
+static const benchmark_t benchmarks[] = {
+    { "string_length", benchmark_string_length },
+    { "compiled_search", benchmark_compiled_search },
+    { "long_needles", benchmark_long_needles },
+    { "pattern_set_build", benchmark_pattern_set_build }
+};
+
+int main(int argc, char* argv[]) {
+    size_t failures = 0;
+
+    for (size_t i = 0; i < sizeof (benchmarks) / sizeof (benchmarks[0]); ++i) {
+        int selected = (argc < 2);
+
+        for (int j = 1; j < argc; ++j) {
+            selected |= (strcmp(argv[j], benchmarks[i].name) == 0);
+        }
+
+        if (selected) {
+            failures += benchmarks[i].run();
+        }
+    }
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
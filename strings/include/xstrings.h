@@ -23,6 +23,8 @@
 #ifndef PROJECT_INCLUDES_XLIBS_STRINGS_H
 #define PROJECT_INCLUDES_XLIBS_STRINGS_H
 
+#include <stdint.h>
+
 /**
  * String searching algorithms recognized by the library.
  *
@@ -33,7 +35,11 @@ typedef enum {
     NAIVE_STRING_SEARCH,
     RABIN_KARP_STRING_SEARCH,
     FINITE_AUTOMATON_STRING_SEARCH,
-    KNUTH_MORRIS_PRATT_STRING_SEARCH
+    KNUTH_MORRIS_PRATT_STRING_SEARCH,
+    GENERIC_SIMD_STRING_SEARCH,
+    TWO_WAY_STRING_SEARCH,
+    BOYER_MOORE_STRING_SEARCH,
+    HORSPOOL_STRING_SEARCH
 } string_search_algorithm_t;
 
 /*
@@ -54,41 +60,1219 @@ const char*
 __attribute__((nonnull(2,3)))
 find_substring(string_search_algorithm_t algorithm, const char* needle, const char* haystack);
 
+/*
+ * Find a buffer within a buffer.
+ *
+ * This function is the length-delimited counterpart of
+ * find_substring(). Neither the needle nor the haystack
+ * need be null-terminated, so it may be used directly on
+ * memory-mapped files and network buffers.
+ *
+ * @param[in] algorithm         The algorithm to use for the search.
+ * @param[in] needle            The substring to look for.
+ * @param[in] needle_length     The length of the needle.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ *
+ * @returns Pointer to the located string. If the substring
+ * is not found, the returned pointer is equal to NULL.
+ *
+ */
+const char*
+__attribute__((nonnull(2,4)))
+find_substring_n(string_search_algorithm_t algorithm, const char* needle, size_t needle_length, const char* haystack, size_t haystack_length);
+
 /**
- * Valid Metric Distance Metrics
+ * Compiled search pattern.
  *
- * This enum defines the valid edit distance calculation
- * algorithms accepted by the calculate_edit_distance()
- * function.
+ * A needle that has already been preprocessed for one of
+ * the string searching algorithms, along with its length.
+ * Searching for a compiled pattern never allocates memory.
  *
- * @typedef edit_distance_t
+ * @typedef search_pattern_t
+ *
+ */
+typedef struct search_pattern search_pattern_t;
+
+/*
+ * Compile a search pattern.
+ *
+ * This function preprocesses the needle for the specified
+ * algorithm, so that it may later be searched for with
+ * find_compiled_pattern() as many times as needed without
+ * repeating the preprocessing step. The needle is copied,
+ * so the caller's buffer need not outlive the pattern.
+ *
+ * @param[in] algorithm The algorithm to use for the search.
+ * @param[in] needle    The substring to look for.
+ *
+ * @returns Pointer to the compiled pattern, which must be
+ * released using free_search_pattern().
+ *
+ */
+search_pattern_t*
+__attribute__((nonnull(2)))
+compile_search_pattern(string_search_algorithm_t algorithm, const char* needle);
+
+/*
+ * Compile a length-delimited search pattern.
+ *
+ * @param[in] algorithm     The algorithm to use for the search.
+ * @param[in] needle        The substring to look for.
+ * @param[in] needle_length The length of the needle.
+ *
+ * @returns Pointer to the compiled pattern, which must be
+ * released using free_search_pattern().
+ *
+ */
+search_pattern_t*
+__attribute__((nonnull(2)))
+compile_search_pattern_n(string_search_algorithm_t algorithm, const char* needle, size_t needle_length);
+
+/*
+ * Find a compiled pattern within a string.
+ *
+ * @param[in] pattern   The compiled substring to look for.
+ * @param[in] haystack  The string to look in.
+ *
+ * @returns Pointer to the located string. If the substring
+ * is not found, the returned pointer is equal to NULL.
+ *
+ */
+const char*
+__attribute__((nonnull(1,2)))
+find_compiled_pattern(const search_pattern_t* pattern, const char* haystack);
+
+/*
+ * Find a compiled pattern within a length-delimited buffer.
+ *
+ * @param[in] pattern           The compiled substring to look for.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ *
+ * @returns Pointer to the located string. If the substring
+ * is not found, the returned pointer is equal to NULL.
+ *
+ */
+const char*
+__attribute__((nonnull(1,2)))
+find_compiled_pattern_n(const search_pattern_t* pattern, const char* haystack, size_t haystack_length);
+
+/*
+ * Free a compiled search pattern.
+ *
+ * @param[in] pattern The pattern to free. May be NULL.
+ *
+ */
+void free_search_pattern(search_pattern_t* pattern);
+
+/**
+ * Substring Match Callback
+ *
+ * Functions of this type are invoked once per match found
+ * by the searching functions that report more than a single
+ * match.
+ *
+ * @param[in] offset    The offset at which the match begins.
+ * @param[in] context   The user-supplied context pointer.
+ *
+ * @returns Zero to continue searching, or any other value
+ * to stop the search.
+ *
+ * @typedef substring_match_callback_t
+ *
+ */
+typedef int (*substring_match_callback_t)(size_t offset, void* context);
+
+/**
+ * Whether functions reporting every match of a needle
+ * should include the matches overlapping a previous one.
+ * Non-overlapping matches are selected greedily, starting
+ * from the leftmost one.
+ *
+ * @enum substring_match_mode_t
  *
  */
 typedef enum {
-    LEVENSHTEIN_DISTANCE,
-    LONGEST_COMMON_SUBSEQUENCE,
-    HAMMING_DISTANCE,
-    DAMERAU_LEVENSHTEIN_DISTANCE,
-    JARO_DISTANCE
-} edit_distance_type_t;
+    NON_OVERLAPPING_MATCHES,
+    OVERLAPPING_MATCHES
+} substring_match_mode_t;
 
 /*
- * Calculate the edit distance of two given strings.
+ * Find every match of a string within a string.
  *
- * In addition to the two input string arguments, this
- * function takes takes a third argument, used to specify
- * the edit distance algorithm to use when calculating the
- * metric.
+ * This function stores the offsets of the matches of the
+ * needle within the haystack in the offsets array, in
+ * increasing order, until the array is full. Every match
+ * is counted, however, so a return value greater than the
+ * capacity of the array indicates that it was too small.
+ * The haystack is scanned exactly once, whatever the
+ * algorithm. An empty needle matches nowhere.
  *
- * @param[in] edit_distance_type    The edit distance metric to use.
- * @param[in] a                     The first string to compare.
- * @param[in] b                     The second string to compare.
+ * @param[in] algorithm The algorithm to use for the search.
+ * @param[in] needle    The substring to look for.
+ * @param[in] haystack  The string to look in.
+ * @param[in] mode      Whether to report overlapping matches.
+ * @param[out] offsets  The array to store the match offsets in.
+ * @param[in] capacity  The number of elements in the offsets array.
  *
- * @returns The edit distance between a and b, as calculated
- * by the edit distance algorithm specified.
+ * @returns The total number of matches found.
  *
  */
-size_t calculate_edit_distance(edit_distance_type_t edit_distance_type, const char* a, const char* b);
+size_t
+__attribute__((nonnull(2,3)))
+find_all_substrings(string_search_algorithm_t algorithm, const char* needle, const char* haystack, substring_match_mode_t mode, size_t* offsets, size_t capacity);
+
+/*
+ * Find every match of a buffer within a buffer.
+ *
+ * @see find_all_substrings()
+ *
+ */
+size_t
+__attribute__((nonnull(2,4)))
+find_all_substrings_n(string_search_algorithm_t algorithm, const char* needle, size_t needle_length, const char* haystack, size_t haystack_length, substring_match_mode_t mode, size_t* offsets, size_t capacity);
+
+/*
+ * Report every match of a buffer within a buffer.
+ *
+ * This function invokes the callback once for every match
+ * of the needle within the haystack, in order of increasing
+ * offset, until either the haystack is exhausted or the
+ * callback returns a nonzero value.
+ *
+ * @param[in] algorithm         The algorithm to use for the search.
+ * @param[in] needle            The substring to look for.
+ * @param[in] needle_length     The length of the needle.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ * @param[in] mode              Whether to report overlapping matches.
+ * @param[in] callback          The function to report matches to.
+ * @param[in] context           User-supplied pointer passed to the callback.
+ *
+ * @returns The number of matches reported to the callback.
+ *
+ */
+size_t
+__attribute__((nonnull(2,4,7)))
+for_each_substring_n(string_search_algorithm_t algorithm, const char* needle, size_t needle_length, const char* haystack, size_t haystack_length, substring_match_mode_t mode, substring_match_callback_t callback, void* context);
+
+/*
+ * Find every match of a compiled pattern.
+ *
+ * @see find_all_substrings()
+ *
+ */
+size_t
+__attribute__((nonnull(1,2)))
+find_all_compiled_pattern_n(const search_pattern_t* pattern, const char* haystack, size_t haystack_length, substring_match_mode_t mode, size_t* offsets, size_t capacity);
+
+/*
+ * Report every match of a compiled pattern.
+ *
+ * @see for_each_substring_n()
+ *
+ */
+size_t
+__attribute__((nonnull(1,2,5)))
+for_each_compiled_pattern_n(const search_pattern_t* pattern, const char* haystack, size_t haystack_length, substring_match_mode_t mode, substring_match_callback_t callback, void* context);
+
+/**
+ * Streaming search context.
+ *
+ * A search stream looks for a single needle in a sequence
+ * of chunks fed to it one at a time, as if they had been
+ * concatenated into a single haystack. Matches straddling
+ * chunk boundaries are found without copying the chunks,
+ * and the memory used is constant in the stream length.
+ *
+ * @typedef search_stream_t
+ *
+ */
+typedef struct search_stream search_stream_t;
+
+/*
+ * Create a streaming search context.
+ *
+ * @param[in] needle The substring to look for.
+ *
+ * @returns Pointer to the search stream, which must be
+ * released using free_search_stream().
+ *
+ */
+search_stream_t*
+__attribute__((nonnull(1)))
+create_search_stream(const char* needle);
+
+/*
+ * Create a streaming search context for a length-delimited needle.
+ *
+ * @param[in] needle        The substring to look for.
+ * @param[in] needle_length The length of the needle.
+ *
+ * @returns Pointer to the search stream, which must be
+ * released using free_search_stream().
+ *
+ */
+search_stream_t*
+__attribute__((nonnull(1)))
+create_search_stream_n(const char* needle, size_t needle_length);
+
+/*
+ * Feed the next chunk of the haystack to a search stream.
+ *
+ * The callback is invoked once for every match completed
+ * within this chunk, with the offset of the start of the
+ * match relative to the beginning of the stream. Matches
+ * may overlap. If the callback asks for the search to stop,
+ * the rest of the chunk is left unconsumed, and it may be
+ * fed again later to resume the search.
+ *
+ * @param[in] stream        The search stream.
+ * @param[in] chunk         The next chunk of the haystack.
+ * @param[in] chunk_length  The length of the chunk.
+ * @param[in] callback      The function to report matches to.
+ * @param[in] context       User-supplied pointer passed to the callback.
+ *
+ * @returns The number of bytes of the chunk consumed.
+ *
+ */
+size_t
+__attribute__((nonnull(1,4)))
+feed_search_stream(search_stream_t* stream, const char* chunk, size_t chunk_length, substring_match_callback_t callback, void* context);
+
+/*
+ * Reset a search stream to the start of a new haystack.
+ *
+ * @param[in] stream The search stream.
+ *
+ */
+void
+__attribute__((nonnull(1)))
+reset_search_stream(search_stream_t* stream);
+
+/*
+ * Free a search stream.
+ *
+ * @param[in] stream The search stream to free. May be NULL.
+ *
+ */
+void free_search_stream(search_stream_t* stream);
+
+/**
+ * Compiled set of search patterns.
+ *
+ * A set of needles searched for together, in a single pass
+ * over the haystack, instead of one pass per needle.
+ *
+ * @typedef search_pattern_set_t
+ *
+ */
+typedef struct search_pattern_set search_pattern_set_t;
+
+/**
+ * Pattern Set Match Callback
+ *
+ * Functions of this type are invoked once per match of any
+ * of the needles in a search pattern set.
+ *
+ * @param[in] needle_index  The index of the matching needle.
+ * @param[in] offset        The offset at which the match begins.
+ * @param[in] context       The user-supplied context pointer.
+ *
+ * @returns Zero to continue searching, or any other value
+ * to stop the search.
+ *
+ * @typedef pattern_set_match_callback_t
+ *
+ */
+typedef int (*pattern_set_match_callback_t)(size_t needle_index, size_t offset, void* context);
+
+/*
+ * Compile a set of search patterns.
+ *
+ * With the Rabin-Karp algorithm, every needle must have the
+ * same length. The hashes of the needles are kept in a
+ * small open-addressing table, so each window of the
+ * haystack is checked against the whole set with a single
+ * hash and a table lookup.
+ *
+ * Every other algorithm compiles the set into an
+ * Aho-Corasick automaton, which accepts needles of any
+ * length and examines each haystack byte once. Empty
+ * needles never match. The needles are copied, and the
+ * compiled set may be searched by several threads at once.
+ *
+ * @param[in] algorithm The algorithm to use for the search.
+ * @param[in] needles   The substrings to look for.
+ * @param[in] count     The number of needles.
+ *
+ * @returns Pointer to the compiled pattern set, which must
+ * be released using free_search_pattern_set(), or NULL if
+ * the needles are not suitable for the algorithm.
+ *
+ */
+search_pattern_set_t*
+__attribute__((nonnull(2)))
+compile_search_pattern_set(string_search_algorithm_t algorithm, const char* const* needles, size_t count);
+
+/*
+ * Compile a set of length-delimited search patterns.
+ *
+ * @param[in] algorithm The algorithm to use for the search.
+ * @param[in] needles   The substrings to look for.
+ * @param[in] lengths   The lengths of the needles.
+ * @param[in] count     The number of needles.
+ *
+ * @returns Pointer to the compiled pattern set, which must
+ * be released using free_search_pattern_set(), or NULL if
+ * the needles are not suitable for the algorithm.
+ *
+ */
+search_pattern_set_t*
+__attribute__((nonnull(2,3)))
+compile_search_pattern_set_n(string_search_algorithm_t algorithm, const char* const* needles, const size_t* lengths, size_t count);
+
+/*
+ * Report every match of a pattern set within a buffer.
+ *
+ * This function invokes the callback once for every match
+ * of any of the needles within the haystack, in order of
+ * increasing end offset, until either the haystack is
+ * exhausted or the callback returns a nonzero value.
+ * Matches of different needles may overlap.
+ *
+ * @param[in] set               The compiled pattern set.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ * @param[in] callback          The function to report matches to.
+ * @param[in] context           User-supplied pointer passed to the callback.
+ *
+ * @returns The number of matches reported to the callback.
+ *
+ */
+size_t
+__attribute__((nonnull(1,2,4)))
+for_each_pattern_set_match_n(const search_pattern_set_t* set, const char* haystack, size_t haystack_length, pattern_set_match_callback_t callback, void* context);
+
+/*
+ * Report every match of a pattern set within a string.
+ *
+ * @see for_each_pattern_set_match_n()
+ *
+ */
+size_t
+__attribute__((nonnull(1,2,3)))
+for_each_pattern_set_match(const search_pattern_set_t* set, const char* haystack, pattern_set_match_callback_t callback, void* context);
+
+/*
+ * Free a compiled pattern set.
+ *
+ * @param[in] set The pattern set to free. May be NULL.
+ *
+ */
+void free_search_pattern_set(search_pattern_set_t* set);
+
+#ifdef XLIBS_INTERNAL
+
+/**
+ * Aho-Corasick Automaton
+ *
+ * Compiled automaton for finding every occurrence of any of
+ * a set of needles in a single pass. It is used both for
+ * finite automaton searches for a single needle, and for
+ * pattern sets.
+ *
+ * @typedef aho_corasick_automaton_t
+ *
+ */
+typedef struct aho_corasick_automaton aho_corasick_automaton_t;
+
+/*
+ * Build an Aho-Corasick automaton. Empty needles never match.
+ *
+ */
+aho_corasick_automaton_t* build_aho_corasick_automaton(const char* const* needles, const size_t* lengths, size_t count);
+
+/*
+ * Run an Aho-Corasick automaton over a buffer, reporting
+ * matches in order of increasing end offset.
+ *
+ */
+size_t run_aho_corasick_automaton(const aho_corasick_automaton_t* automaton, const char* haystack, size_t h, pattern_set_match_callback_t callback, void* context);
+
+/*
+ * Free an Aho-Corasick automaton.
+ *
+ */
+void free_aho_corasick_automaton(aho_corasick_automaton_t* automaton);
+
+#if defined(__x86_64__) && defined(__ELF__)
+
+/*
+ * The vectorized implementations of string_length(), which
+ * the caller must check the host supports.
+ *
+ */
+size_t string_length_sse2(const char* string);
+size_t string_length_avx2(const char* string);
+size_t string_length_avx512bw(const char* string);
+
+#endif
+
+/**
+ * Compiled Search Pattern
+ *
+ * A search pattern bundles a needle together with every
+ * piece of information the selected searching algorithm
+ * would otherwise have to recompute on each call: the
+ * length of the needle and the algorithm's preprocessing
+ * tables. Once compiled, a pattern can be searched for in
+ * any number of haystacks without any further allocations.
+ *
+ * @struct search_pattern
+ *
+ */
+struct search_pattern {
+    /** The searching function selected at compile time. */
+    const char* (*search)(const search_pattern_t*, const char*, size_t, substring_match_callback_t, void*);
+
+    /** The substring to search for. */
+    const char* needle;
+
+    /** The length of the needle, minus null terminator. */
+    size_t length;
+
+    /** Knuth-Morris-Pratt prefix function of the needle. */
+    size_t* prefix;
+
+    /** Rabin-Karp hash of the needle. */
+    size_t hash;
+
+    /** Weight of the leading character in the Rabin-Karp hash. */
+    size_t high_order;
+
+    /** String-matching automaton for the needle. */
+    aho_corasick_automaton_t* automaton;
+
+    /** Two-Way critical factorization position of the needle. */
+    size_t critical;
+
+    /** Two-Way shift after a match of the right half. */
+    size_t period;
+
+    /** Whether the needle's left half repeats with that period. */
+    int periodic;
+
+    /** Bad-character shift for each byte value. */
+    size_t* skip;
+
+    /** Boyer-Moore good-suffix shift for each needle position. */
+    size_t* good_suffix;
+};
+
+/**
+ * Rabin-Karp Hash Base
+ *
+ * The Rabin-Karp hash of a string is the value of the
+ * polynomial with the string's characters as coefficients,
+ * evaluated at this base, modulo the word size. Since the
+ * base is odd, the modulo operation is simply the natural
+ * wraparound of unsigned arithmetic, and rolling the hash
+ * forward takes just two multiplications.
+ *
+ * @def RABIN_KARP_HASH_BASE
+ *
+ */
+#define RABIN_KARP_HASH_BASE ((size_t) 0x100000001B3ULL)
+
+/**
+ * Compute the Rabin-Karp hash of the first m characters of s.
+ *
+ */
+static inline size_t rabin_karp_hash(const char* s, size_t m) {
+    size_t hash = 0;
+
+    for (size_t i = 0; i < m; ++i) {
+        hash = hash * RABIN_KARP_HASH_BASE + (unsigned char) s[i];
+    }
+
+    return hash;
+}
+
+/**
+ * Compute the weight of the leading character of an m
+ * character window in its Rabin-Karp hash.
+ *
+ */
+static inline size_t rabin_karp_high_order(size_t m) {
+    size_t high_order = 1;
+
+    for (size_t i = 1; i < m; ++i) {
+        high_order *= RABIN_KARP_HASH_BASE;
+    }
+
+    return high_order;
+}
+
+/**
+ * Slide a Rabin-Karp hash window forward by one character.
+ *
+ */
+static inline size_t rabin_karp_roll(size_t hash, char out, char in, size_t high_order) {
+    return (hash - (unsigned char) out * high_order) * RABIN_KARP_HASH_BASE + (unsigned char) in;
+}
+
+#endif /** XLIBS_INTERNAL */
+
+/**
+ * Valid Metric Distance Metrics
+ *
+ * This enum defines the valid edit distance calculation
+ * algorithms accepted by the calculate_edit_distance()
+ * function. The LONGEST_COMMON_SUBSEQUENCE metric yields
+ * the length of the longest common subsequence, which grows
+ * with the similarity of the strings rather than with their
+ * distance. The JARO_DISTANCE metric yields the complement
+ * of the Jaro similarity scaled to the length of the longer
+ * string, rounded up, so that it is zero only for
+ * identical strings and that length for strings with
+ * nothing in common.
+ *
+ * @typedef edit_distance_t
+ *
+ */
+typedef enum {
+    LEVENSHTEIN_DISTANCE,
+    LONGEST_COMMON_SUBSEQUENCE,
+    HAMMING_DISTANCE,
+    DAMERAU_LEVENSHTEIN_DISTANCE,
+    JARO_DISTANCE,
+    OPTIMAL_STRING_ALIGNMENT_DISTANCE
+} edit_distance_type_t;
+
+/*
+ * Calculate the edit distance of two given strings.
+ *
+ * In addition to the two input string arguments, this
+ * function takes takes a third argument, used to specify
+ * the edit distance algorithm to use when calculating the
+ * metric.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The first string to compare.
+ * @param[in] b                     The second string to compare.
+ *
+ * @returns The edit distance between a and b, as calculated
+ * by the edit distance algorithm specified.
+ *
+ */
+size_t calculate_edit_distance(edit_distance_type_t edit_distance_type, const char* a, const char* b);
+
+/*
+ * Calculate the edit distance of two given buffers.
+ *
+ * This function is the length-delimited counterpart of
+ * calculate_edit_distance(). Neither buffer need be
+ * null-terminated.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The first buffer to compare.
+ * @param[in] a_length              The length of a.
+ * @param[in] b                     The second buffer to compare.
+ * @param[in] b_length              The length of b.
+ *
+ * @returns The edit distance between a and b, as calculated
+ * by the edit distance algorithm specified.
+ *
+ */
+size_t calculate_edit_distance_n(edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length);
+
+/**
+ * Bounded Edit Distance Exceeded
+ *
+ * This value is returned by the bounded edit distance
+ * functions when the distance exceeds the given bound.
+ *
+ * @def EDIT_DISTANCE_EXCEEDED
+ *
+ */
+#define EDIT_DISTANCE_EXCEEDED ((size_t) -1)
+
+/*
+ * Calculate the edit distance of two strings, up to a bound.
+ *
+ * This function is meant for callers that only need to know
+ * whether the distance between two strings is at most the
+ * given bound. The Levenshtein distance is computed only
+ * along the diagonals of the dynamic programming matrix
+ * that can lead to a distance within the bound, and the
+ * computation stops as soon as the bound is certain to be
+ * exceeded. Strings whose lengths differ by more than the
+ * bound are rejected without any further work. The other
+ * metrics compute the full distance before comparing it.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The first string to compare.
+ * @param[in] b                     The second string to compare.
+ * @param[in] max                   The largest distance of interest.
+ *
+ * @returns The edit distance between a and b, if it is at
+ * most max, or EDIT_DISTANCE_EXCEEDED otherwise.
+ *
+ */
+size_t calculate_edit_distance_bounded(edit_distance_type_t edit_distance_type, const char* a, const char* b, size_t max);
+
+/*
+ * Calculate the edit distance of two buffers, up to a bound.
+ *
+ * @see calculate_edit_distance_bounded()
+ *
+ */
+size_t calculate_edit_distance_bounded_n(edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length, size_t max);
+
+/**
+ * Edit Distance Workspace
+ *
+ * A workspace owns the scratch memory used by the edit
+ * distance calculations. The plain functions allocate and
+ * release their scratch memory on every call; a caller
+ * computing many distances, such as a worker thread with a
+ * small stack comparing large documents, can instead keep a
+ * workspace of its own and pass it to the _workspace
+ * variants, which reuse its memory and only grow it when
+ * an input is larger than any seen before. No scratch
+ * memory is ever placed on the stack in proportion to the
+ * input lengths.
+ *
+ * A workspace may be used by only one thread at a time.
+ *
+ * @typedef edit_distance_workspace_t
+ *
+ */
+typedef struct edit_distance_workspace edit_distance_workspace_t;
+
+/*
+ * Create an edit distance workspace.
+ *
+ * @param[in] capacity The number of bytes to reserve up front.
+ *
+ * @returns A new workspace, to be released with
+ * free_edit_distance_workspace().
+ *
+ */
+edit_distance_workspace_t* create_edit_distance_workspace(size_t capacity);
+
+/*
+ * Calculate the edit distance of two buffers, using the
+ * given workspace for scratch memory.
+ *
+ * @see calculate_edit_distance_n()
+ *
+ */
+size_t
+__attribute__((nonnull(1,3,5)))
+calculate_edit_distance_workspace_n(edit_distance_workspace_t* workspace, edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length);
+
+/*
+ * Calculate the edit distance of two buffers, up to a bound,
+ * using the given workspace for scratch memory.
+ *
+ * @see calculate_edit_distance_bounded_n()
+ *
+ */
+size_t
+__attribute__((nonnull(1,3,5)))
+calculate_edit_distance_bounded_workspace_n(edit_distance_workspace_t* workspace, edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length, size_t max);
+
+/*
+ * Release an edit distance workspace.
+ *
+ * @param[in] workspace The workspace to release.
+ *
+ */
+void free_edit_distance_workspace(edit_distance_workspace_t* workspace);
+
+/*
+ * Calculate the edit distance of one string to many.
+ *
+ * This function is meant for fuzzy lookups, in which a
+ * single query is compared against a whole dictionary. The
+ * query is measured and preprocessed only once, the
+ * Levenshtein distances of several candidates are computed
+ * at once in the lanes of a vector register when the query
+ * fits in a machine word, and large batches are spread over
+ * one thread per processor.
+ *
+ * The threads belong to a pool that is started by the first
+ * batch that needs it and reused by every later one, so
+ * that a batch only wakes them up. A batch takes one thread
+ * for every 4096 candidates, so that batches of at most
+ * 4096 candidates run on the calling thread alone, as do
+ * batches that arrive while another thread's batch has the
+ * pool.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] query                 The string to compare the candidates to.
+ * @param[in] candidates            The strings to compare the query to.
+ * @param[in] count                 The number of candidates.
+ * @param[out] distances            The distance of each candidate to the query.
+ *
+ */
+void
+__attribute__((nonnull(2,5)))
+calculate_edit_distance_batch(edit_distance_type_t edit_distance_type, const char* query, const char* const* candidates, size_t count, size_t* distances);
+
+/*
+ * Calculate the edit distance of one buffer to many.
+ *
+ * The candidate_lengths array may be NULL, in which case
+ * the candidates must be null-terminated strings.
+ *
+ * @see calculate_edit_distance_batch()
+ *
+ */
+void
+__attribute__((nonnull(2,7)))
+calculate_edit_distance_batch_n(edit_distance_type_t edit_distance_type, const char* query, size_t query_length, const char* const* candidates, const size_t* candidate_lengths, size_t count, size_t* distances);
+
+/*
+ * Find the candidates nearest to a string.
+ *
+ * This function computes the edit distances of the
+ * candidates to the query as calculate_edit_distance_batch()
+ * does, but it only keeps the k nearest of them, so that no
+ * memory proportional to the number of candidates is needed.
+ * Candidates at the same distance are ranked by index.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] query                 The string to compare the candidates to.
+ * @param[in] candidates            The strings to compare the query to.
+ * @param[in] count                 The number of candidates.
+ * @param[in] k                     The number of nearest candidates to find.
+ * @param[out] indices              The indices of the nearest candidates.
+ * @param[out] distances            Their distances to the query, or NULL.
+ *
+ * @returns The number of candidates found, the smaller of
+ * k and count, whose indices are stored in increasing order
+ * of distance.
+ *
+ */
+size_t
+__attribute__((nonnull(2,6)))
+find_nearest_candidates(edit_distance_type_t edit_distance_type, const char* query, const char* const* candidates, size_t count, size_t k, size_t* indices, size_t* distances);
+
+/*
+ * Find the candidates nearest to a buffer.
+ *
+ * The candidate_lengths array may be NULL, in which case
+ * the candidates must be null-terminated strings.
+ *
+ * @see find_nearest_candidates()
+ *
+ */
+size_t
+__attribute__((nonnull(2,8)))
+find_nearest_candidates_n(edit_distance_type_t edit_distance_type, const char* query, size_t query_length, const char* const* candidates, const size_t* candidate_lengths, size_t count, size_t k, size_t* indices, size_t* distances);
+
+/*
+ * Calculate the Hamming distance between two bit vectors.
+ *
+ * This function is meant for comparing binary fingerprints,
+ * such as simhashes, packed 64 bits to a word. The bits are
+ * compared with an exclusive or, and the differences counted
+ * with the widest population count instruction supported by
+ * the host.
+ *
+ * @param[in] a The first bit vector to compare.
+ * @param[in] b The second bit vector to compare.
+ * @param[in] count The number of 64-bit words in both bit vectors.
+ *
+ * @returns The number of bits in which a and b differ.
+ *
+ */
+size_t
+__attribute__((nonnull(1,2)))
+calculate_packed_hamming_distance(const uint64_t* a, const uint64_t* b, size_t count);
+
+/*
+ * Calculate the length of the longest common subsequence
+ * of two arrays of 32-bit tokens.
+ *
+ * This function is the token counterpart of the
+ * LONGEST_COMMON_SUBSEQUENCE metric, meant for inputs such
+ * as the lines of two files, each interned as a token ID.
+ * It takes time proportional to the product of the lengths
+ * divided by 64, and memory linear in the sum of the
+ * lengths.
+ *
+ * @param[in] a The first array of tokens.
+ * @param[in] a_length The number of tokens in a.
+ * @param[in] b The second array of tokens.
+ * @param[in] b_length The number of tokens in b.
+ *
+ * @returns The length of the longest common subsequence of
+ * a and b.
+ *
+ */
+size_t
+__attribute__((nonnull(1,3)))
+calculate_token_longest_common_subsequence(const uint32_t* a, size_t a_length, const uint32_t* b, size_t b_length);
+
+/**
+ * Edit Operation Types
+ *
+ * The operations of an edit script. A match or a
+ * substitution consumes a character of both the source and
+ * the target, a deletion one of the source only, and an
+ * insertion one of the target only.
+ *
+ * @typedef edit_operation_type_t
+ *
+ */
+typedef enum {
+    EDIT_MATCH,
+    EDIT_SUBSTITUTION,
+    EDIT_INSERTION,
+    EDIT_DELETION
+} edit_operation_type_t;
+
+/**
+ * Edit Operation
+ *
+ * A run of consecutive edit operations of the same type.
+ * Successive runs of an edit script are always of
+ * different types.
+ *
+ * @typedef edit_operation_t
+ *
+ */
+typedef struct {
+    edit_operation_type_t type;
+    size_t length;
+} edit_operation_t;
+
+/*
+ * Calculate an edit script transforming one string into
+ * another.
+ *
+ * The script is an optimal alignment of the two strings
+ * under the given metric, which must be either the
+ * Levenshtein distance or the longest common subsequence,
+ * whose scripts contain no substitutions. The distance is
+ * the total length of the runs other than matches, and the
+ * length of the longest common subsequence that of the
+ * matches.
+ *
+ * The alignment is found with Hirschberg's algorithm, so it
+ * takes time proportional to the product of the lengths of
+ * the strings, but memory only linear in the length of b.
+ * The runs are written to the caller's array, which need
+ * hold no more than a_length + b_length of them; if it
+ * is too small, the runs past its capacity are dropped, and
+ * the return value tells how many there are in all.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The source string.
+ * @param[in] b                     The target string.
+ * @param[out] script               The array to write the runs to.
+ * @param[in] capacity              The number of runs script can hold.
+ *
+ * @returns The number of runs in the edit script.
+ *
+ */
+size_t
+__attribute__((nonnull(2,3)))
+calculate_edit_script(edit_distance_type_t edit_distance_type, const char* a, const char* b, edit_operation_t* script, size_t capacity);
+
+/*
+ * Calculate an edit script transforming one buffer into
+ * another.
+ *
+ * @see calculate_edit_script()
+ *
+ */
+size_t
+__attribute__((nonnull(2,4)))
+calculate_edit_script_n(edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length, edit_operation_t* script, size_t capacity);
+
+/*
+ * Calculate an edit script transforming one buffer into
+ * another, using the given workspace for scratch memory.
+ *
+ * @see calculate_edit_script()
+ *
+ */
+size_t
+__attribute__((nonnull(1,3,5)))
+calculate_edit_script_workspace_n(edit_distance_workspace_t* workspace, edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length, edit_operation_t* script, size_t capacity);
+
+/**
+ * String Similarity Metrics
+ *
+ * This enum defines the similarity metrics accepted by the
+ * calculate_string_similarity() function. Unlike the edit
+ * distances, these are fractions, ranging from 0 for
+ * entirely dissimilar strings to 1 for identical ones.
+ *
+ * @typedef string_similarity_type_t
+ *
+ */
+typedef enum {
+    JARO_SIMILARITY,
+    JARO_WINKLER_SIMILARITY
+} string_similarity_type_t;
+
+/*
+ * Calculate the similarity of two given strings.
+ *
+ * Neither metric allocates any memory for strings of up to
+ * 64 characters, so the function is suited to comparing
+ * very large numbers of short strings, such as names in
+ * record linkage.
+ *
+ * @param[in] string_similarity_type    The similarity metric to use.
+ * @param[in] a                         The first string to compare.
+ * @param[in] b                         The second string to compare.
+ *
+ * @returns The similarity of a and b, between 0 and 1.
+ *
+ */
+double
+__attribute__((nonnull(2,3)))
+calculate_string_similarity(string_similarity_type_t string_similarity_type, const char* a, const char* b);
+
+/*
+ * Calculate the similarity of two given buffers.
+ *
+ * @see calculate_string_similarity()
+ *
+ */
+double
+__attribute__((nonnull(2,4)))
+calculate_string_similarity_n(string_similarity_type_t string_similarity_type, const char* a, size_t a_length, const char* b, size_t b_length);
+
+/**
+ * Fuzzy Index
+ *
+ * A fuzzy index answers queries for the words of a fixed
+ * vocabulary within a given Levenshtein distance of a term,
+ * without comparing the term to every word. It combines a
+ * BK-tree, which prunes the words whose distance to the
+ * term is ruled out by the triangle inequality, with an
+ * inverted index of the bigrams of each word, which rules
+ * out the words sharing too few bigrams with the term.
+ *
+ * An index is stored in a single flat block of memory,
+ * which can be saved to a file and later mapped back into
+ * memory without any parsing or copying. Saved indexes are
+ * only portable between hosts of the same byte order. An
+ * index holds fewer than 2^32 words.
+ *
+ * @typedef fuzzy_index_t
+ *
+ */
+typedef struct fuzzy_index fuzzy_index_t;
+
+/**
+ * Fuzzy Match Callback
+ *
+ * Callback function invoked for each word of a fuzzy index
+ * within the distance of interest of a query term.
+ *
+ * @param[in] word_index The index of the word in the vocabulary.
+ * @param[in] distance The distance of the word to the term.
+ * @param[in] context User-supplied pointer passed to the query.
+ *
+ * @returns Nonzero to stop the query, or zero to continue.
+ *
+ * @typedef fuzzy_match_callback_t
+ *
+ */
+typedef int (*fuzzy_match_callback_t)(size_t word_index, size_t distance, void* context);
+
+/*
+ * Build a fuzzy index over an array of strings.
+ *
+ * @param[in] words The vocabulary to index.
+ * @param[in] count The number of words.
+ *
+ * @returns A new fuzzy index, to be released with
+ * free_fuzzy_index().
+ *
+ */
+fuzzy_index_t* build_fuzzy_index(const char* const* words, size_t count);
+
+/*
+ * Build a fuzzy index over an array of buffers.
+ *
+ * The lengths array may be NULL, in which case the words
+ * must be null-terminated strings.
+ *
+ * @see build_fuzzy_index()
+ *
+ */
+fuzzy_index_t* build_fuzzy_index_n(const char* const* words, const size_t* lengths, size_t count);
+
+/*
+ * Find the words of a fuzzy index near a term.
+ *
+ * Every word within max_distance of the term is reported to
+ * the callback, along with its distance, in no particular
+ * order.
+ *
+ * @param[in] index The index to query.
+ * @param[in] term The term to look for.
+ * @param[in] max_distance The largest distance of interest.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns The number of words reported.
+ *
+ */
+size_t
+__attribute__((nonnull(1,2,4)))
+query_fuzzy_index(const fuzzy_index_t* index, const char* term, size_t max_distance, fuzzy_match_callback_t callback, void* context);
+
+/*
+ * Find the words of a fuzzy index near a buffer.
+ *
+ * @see query_fuzzy_index()
+ *
+ */
+size_t
+__attribute__((nonnull(1,2,5)))
+query_fuzzy_index_n(const fuzzy_index_t* index, const char* term, size_t term_length, size_t max_distance, fuzzy_match_callback_t callback, void* context);
+
+/**
+ * Fuzzy Index Workspace
+ *
+ * A workspace owns the scratch memory of fuzzy index
+ * queries. The plain query functions allocate and release
+ * it on every call, including a counter for every word of
+ * the vocabulary; a caller making many queries can instead
+ * keep a workspace of its own and pass it to
+ * query_fuzzy_index_workspace_n(), which only clears the
+ * counters each query touched. A workspace may be used with
+ * any index, but by only one thread at a time.
+ *
+ * @typedef fuzzy_index_workspace_t
+ *
+ */
+typedef struct fuzzy_index_workspace fuzzy_index_workspace_t;
+
+/*
+ * Create a fuzzy index workspace.
+ *
+ * @returns A new workspace, to be released with
+ * free_fuzzy_index_workspace().
+ *
+ */
+fuzzy_index_workspace_t* create_fuzzy_index_workspace(void);
+
+/*
+ * Find the words of a fuzzy index near a buffer, using the
+ * given workspace for scratch memory.
+ *
+ * @see query_fuzzy_index()
+ *
+ */
+size_t
+__attribute__((nonnull(1,2,3,6)))
+query_fuzzy_index_workspace_n(fuzzy_index_workspace_t* workspace, const fuzzy_index_t* index, const char* term, size_t term_length, size_t max_distance, fuzzy_match_callback_t callback, void* context);
+
+/*
+ * Release a fuzzy index workspace.
+ *
+ * @param[in] workspace The workspace to release.
+ *
+ */
+void free_fuzzy_index_workspace(fuzzy_index_workspace_t* workspace);
+
+/*
+ * Get the number of words in a fuzzy index.
+ *
+ */
+size_t
+__attribute__((nonnull(1)))
+get_fuzzy_index_size(const fuzzy_index_t* index);
+
+/*
+ * Get a word of a fuzzy index, as a null-terminated string.
+ *
+ */
+const char*
+__attribute__((nonnull(1)))
+get_fuzzy_index_word(const fuzzy_index_t* index, size_t word_index);
+
+/*
+ * Save a fuzzy index to a file.
+ *
+ * @param[in] index The index to save.
+ * @param[in] path The path of the file to write.
+ *
+ * @returns Zero on success, or -1 if the file could not be
+ * written.
+ *
+ */
+int
+__attribute__((nonnull(1,2)))
+save_fuzzy_index(const fuzzy_index_t* index, const char* path);
+
+/*
+ * Load a fuzzy index saved by save_fuzzy_index().
+ *
+ * The file is mapped into memory read-only and used in
+ * place. Every array of the index is checked once while
+ * loading, so that a truncated or corrupt file is rejected
+ * instead of sending a later query out of bounds.
+ *
+ * @param[in] path The path of the file to load.
+ *
+ * @returns The loaded index, to be released with
+ * free_fuzzy_index(), or NULL if the file could not be
+ * mapped or does not hold a valid index.
+ *
+ */
+fuzzy_index_t*
+__attribute__((nonnull(1)))
+load_fuzzy_index(const char* path);
+
+/*
+ * Release a fuzzy index.
+ *
+ */
+void free_fuzzy_index(fuzzy_index_t* index);
+
+#ifdef XLIBS_INTERNAL
+
+/*
+ * Reserve at least size bytes of the workspace's memory.
+ *
+ */
+void* reserve_edit_distance_workspace(edit_distance_workspace_t* workspace, size_t size);
+
+/*
+ * Build the bit-parallel Levenshtein match masks of a.
+ *
+ */
+void build_levenshtein_match_masks(uint64_t* peq, size_t blocks, const char* a, size_t m);
+
+/*
+ * Calculate the Levenshtein distance of a string of at most
+ * 64 characters, given by its match masks, to b.
+ *
+ */
+size_t run_levenshtein_single_word(const uint64_t* peq, size_t m, const char* b, size_t n);
+
+/*
+ * Calculate the Levenshtein distance of a string of any
+ * length, given by its match masks, to b.
+ *
+ */
+size_t run_levenshtein_blocked(const uint64_t* peq, size_t blocks, uint64_t* vp, uint64_t* vn, size_t m, const char* b, size_t n);
+
+#endif /** XLIBS_INTERNAL */
 
 /*
  * Calculate the length of the given string.
@@ -0,0 +1,810 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ * 
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ * 
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xstrings.h"
+
+/**
+ * Dense Automaton State Limit
+ *
+ * Automata with at most this many states store a complete
+ * deterministic transition table, with one entry for every
+ * state and input byte, so that matching costs a single
+ * table lookup per haystack byte. The table takes 1 KiB per
+ * state, so larger automata instead use a compressed
+ * double-array layout of the goto function, following
+ * failure links at run time.
+ *
+ * @def AHO_CORASICK_DENSE_STATE_LIMIT
+ *
+ */
+#ifndef AHO_CORASICK_DENSE_STATE_LIMIT
+#define AHO_CORASICK_DENSE_STATE_LIMIT 1024
+#endif
+
+/**
+ * This value marks the absence of a state, a needle, or a
+ * double-array owner.
+ *
+ * @def AHO_CORASICK_NONE
+ *
+ */
+#define AHO_CORASICK_NONE ((uint32_t) -1)
+
+/**
+ * Double-Array Placement Attempts
+ *
+ * A free position of the double array stops being tried as
+ * the place of the first child of a state once this many
+ * states have failed to fit there. It stays free, and may
+ * still be taken by any other child, but the search for a
+ * base no longer has to walk past every small hole at the
+ * front of a nearly full array.
+ *
+ * @def AHO_CORASICK_PLACEMENT_ATTEMPTS
+ *
+ */
+#ifndef AHO_CORASICK_PLACEMENT_ATTEMPTS
+#define AHO_CORASICK_PLACEMENT_ATTEMPTS 16
+#endif
+
+/**
+ * Aho-Corasick Trie Node
+ *
+ * The trie is only used while the automaton is built. Its
+ * children are kept in sibling lists, so that building it
+ * takes memory proportional to the total needle length
+ * regardless of the alphabet size.
+ *
+ * @struct aho_corasick_node_t
+ *
+ */
+typedef struct {
+    uint32_t first_child;
+    uint32_t next_sibling;
+    uint32_t fail;
+    uint32_t dictionary;
+    uint32_t output;
+    unsigned char label;
+} aho_corasick_node_t;
+
+/**
+ * Aho-Corasick Automaton
+ *
+ * States are numbered in breadth-first order in the dense
+ * layout, and by their position in the double array in the
+ * compressed one. In both layouts, each state records the
+ * first needle ending there, and its dictionary link, which
+ * is the nearest state along its failure chain at which
+ * some other needle ends.
+ *
+ * @struct aho_corasick_automaton
+ *
+ */
+struct aho_corasick_automaton {
+    /** The number of needles, and their lengths. */
+    size_t needle_count;
+    size_t* lengths;
+
+    /** The next needle identical to each needle, if any. */
+    uint32_t* duplicates;
+
+    /** The number of entries in the per-state arrays. */
+    size_t state_count;
+
+    /** The first needle ending at each state. */
+    uint32_t* output;
+
+    /** The dictionary link of each state. */
+    uint32_t* dictionary;
+
+    /** Complete transition table, in the dense layout. */
+    uint32_t* transitions;
+
+    /** Double-array goto function and failure links. */
+    uint32_t* base;
+    uint32_t* check;
+    uint32_t* fail;
+};
+
+/**
+ * Allocate memory for an automaton, exiting the program if
+ * the allocation fails.
+ *
+ * @param[in] size The number of bytes to allocate.
+ *
+ * @returns Pointer to the allocated memory.
+ *
+ */
+static void* allocate_automaton_memory(size_t size) {
+    void* memory = malloc(size);
+
+    if (memory == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    return memory;
+}
+
+/**
+ * Trie Child Table
+ *
+ * An open-addressing hash table from a node and a label to
+ * the child of the node with that label. The sibling lists
+ * alone would make every lookup walk up to 256 children,
+ * which, repeated along every failure chain, dominates the
+ * build of large needle sets. Each slot holds the parent
+ * and the child; the label is that of the child.
+ *
+ * @struct trie_child_table_t
+ *
+ */
+typedef struct {
+    uint32_t* parents;
+    uint32_t* children;
+    size_t mask;
+} trie_child_table_t;
+
+/**
+ * Hash Trie Edge
+ *
+ */
+static inline size_t hash_trie_edge(uint32_t node, unsigned char label) {
+    return (size_t) ((((uint64_t) node << 8) | label) * UINT64_C(0x9E3779B97F4A7C15) >> 32);
+}
+
+/**
+ * Find the child of a trie node with the given label.
+ *
+ * @returns The index of the child, or AHO_CORASICK_NONE.
+ *
+ */
+static uint32_t find_trie_child(const aho_corasick_node_t* trie, const trie_child_table_t* table, uint32_t node, unsigned char label) {
+    for (size_t slot = hash_trie_edge(node, label) & table->mask; table->children[slot] != AHO_CORASICK_NONE; slot = (slot + 1) & table->mask) {
+        if ((table->parents[slot] == node) && (trie[table->children[slot]].label == label)) {
+            return table->children[slot];
+        }
+    }
+
+    return AHO_CORASICK_NONE;
+}
+
+/**
+ * Insert Trie Child
+ *
+ */
+static void insert_trie_child(const aho_corasick_node_t* trie, trie_child_table_t* table, uint32_t node, uint32_t child) {
+    size_t slot = hash_trie_edge(node, trie[child].label) & table->mask;
+
+    while (table->children[slot] != AHO_CORASICK_NONE) {
+        slot = (slot + 1) & table->mask;
+    }
+
+    table->parents[slot] = node;
+    table->children[slot] = child;
+}
+
+/**
+ * Build Aho-Corasick Trie
+ *
+ * This function inserts every needle into a trie rooted at
+ * node zero, and returns the nodes in breadth-first order,
+ * with their failure and dictionary links computed.
+ *
+ * @param[in] needles   The substrings to look for.
+ * @param[in] lengths   The lengths of the needles.
+ * @param[in] count     The number of needles.
+ * @param[out] duplicates The next needle identical to each needle.
+ * @param[out] node_count The number of nodes in the trie.
+ * @param[out] order    The nodes of the trie in breadth-first order.
+ *
+ * @returns The trie.
+ *
+ */
+static aho_corasick_node_t* build_trie(const char* const* needles, const size_t* lengths, size_t count, uint32_t* duplicates, size_t* node_count, uint32_t** order) {
+    size_t capacity = 1;
+
+    for (size_t i = 0; i < count; ++i) {
+        capacity += lengths[i];
+    }
+
+    aho_corasick_node_t* trie = allocate_automaton_memory(sizeof (aho_corasick_node_t) * capacity);
+    size_t nodes = 1;
+
+    /** Keep the table at most half full. */
+    size_t slots = 16;
+
+    while (slots < 2 * capacity) {
+        slots *= 2;
+    }
+
+    trie_child_table_t table;
+
+    table.parents = allocate_automaton_memory(sizeof (uint32_t) * slots);
+    table.children = allocate_automaton_memory(sizeof (uint32_t) * slots);
+    table.mask = slots - 1;
+
+    memset(table.children, 0xFF, sizeof (uint32_t) * slots);
+
+    trie[0] = (aho_corasick_node_t) { AHO_CORASICK_NONE, AHO_CORASICK_NONE, 0, AHO_CORASICK_NONE, AHO_CORASICK_NONE, 0 };
+
+
+    for (size_t i = 0; i < count; ++i) {
+        duplicates[i] = AHO_CORASICK_NONE;
+
+        /** Empty needles never match. */
+        if (lengths[i] == 0) {
+            continue;
+        }
+
+        uint32_t node = 0;
+
+        for (size_t j = 0; j < lengths[i]; ++j) {
+            const unsigned char label = (unsigned char) needles[i][j];
+            uint32_t child = find_trie_child(trie, &table, node, label);
+
+            if (child == AHO_CORASICK_NONE) {
+                child = (uint32_t) nodes++;
+                trie[child] = (aho_corasick_node_t) { AHO_CORASICK_NONE, trie[node].first_child, 0, AHO_CORASICK_NONE, AHO_CORASICK_NONE, label };
+                trie[node].first_child = child;
+
+                insert_trie_child(trie, &table, node, child);
+            }
+
+            node = child;
+        }
+
+        duplicates[i] = trie[node].output;
+        trie[node].output = (uint32_t) i;
+    }
+
+    /**
+     * The failure link of a node points to the node for the
+     * longest proper suffix of its string that is also in
+     * the trie. Since that suffix is shorter, it has always
+     * been visited already in breadth-first order.
+     *
+     */
+    uint32_t* queue = allocate_automaton_memory(sizeof (uint32_t) * nodes);
+    size_t head = 0;
+    size_t tail = 0;
+
+    queue[tail++] = 0;
+
+    while (head < tail) {
+        const uint32_t node = queue[head++];
+
+        for (uint32_t child = trie[node].first_child; child != AHO_CORASICK_NONE; child = trie[child].next_sibling) {
+            uint32_t fail = 0;
+
+            if (node != 0) {
+                fail = trie[node].fail;
+
+                while ((fail != 0) && (find_trie_child(trie, &table, fail, trie[child].label) == AHO_CORASICK_NONE)) {
+                    fail = trie[fail].fail;
+                }
+
+                const uint32_t next = find_trie_child(trie, &table, fail, trie[child].label);
+                fail = (next == AHO_CORASICK_NONE) ? 0 : next;
+            }
+
+            trie[child].fail = fail;
+            trie[child].dictionary = (trie[fail].output != AHO_CORASICK_NONE) ? fail : trie[fail].dictionary;
+
+            queue[tail++] = child;
+        }
+    }
+
+    free(table.parents);
+    free(table.children);
+
+    *node_count = nodes;
+    *order = queue;
+
+    return trie;
+}
+
+/**
+ * Build Dense Automaton
+ *
+ * This function converts the trie into a complete
+ * deterministic automaton, in which the transition of a
+ * node that has no child for a byte is the transition of
+ * its failure node for that byte.
+ *
+ */
+static void build_dense_automaton(aho_corasick_automaton_t* automaton, const aho_corasick_node_t* trie, size_t nodes, const uint32_t* order) {
+    uint32_t* state = allocate_automaton_memory(sizeof (uint32_t) * nodes);
+
+    for (size_t i = 0; i < nodes; ++i) {
+        state[order[i]] = (uint32_t) i;
+    }
+
+    automaton->state_count = nodes;
+    automaton->transitions = allocate_automaton_memory(sizeof (uint32_t) * nodes * 256);
+    automaton->output = allocate_automaton_memory(sizeof (uint32_t) * nodes);
+    automaton->dictionary = allocate_automaton_memory(sizeof (uint32_t) * nodes);
+
+    for (size_t i = 0; i < nodes; ++i) {
+        const uint32_t node = order[i];
+        uint32_t* row = automaton->transitions + (i * 256);
+
+        if (node == 0) {
+            memset(row, 0, sizeof (uint32_t) * 256);
+        } else {
+            memcpy(row, automaton->transitions + ((size_t) state[trie[node].fail] * 256), sizeof (uint32_t) * 256);
+        }
+
+        for (uint32_t child = trie[node].first_child; child != AHO_CORASICK_NONE; child = trie[child].next_sibling) {
+            row[trie[child].label] = state[child];
+        }
+
+        automaton->output[i] = trie[node].output;
+        automaton->dictionary[i] = (trie[node].dictionary == AHO_CORASICK_NONE) ? AHO_CORASICK_NONE : state[trie[node].dictionary];
+    }
+
+    free(state);
+}
+
+/**
+ * Grow the double-array so that it holds at least size entries.
+ *
+ */
+static void grow_double_array(aho_corasick_automaton_t* automaton, size_t size) {
+    if (size <= automaton->state_count) {
+        return;
+    }
+
+    size_t capacity = (automaton->state_count > 0) ? automaton->state_count : 512;
+
+    while (capacity < size) {
+        capacity *= 2;
+    }
+
+    uint32_t** arrays[] = { &automaton->base, &automaton->check, &automaton->fail, &automaton->output, &automaton->dictionary };
+
+    for (size_t i = 0; i < sizeof (arrays) / sizeof (arrays[0]); ++i) {
+        uint32_t* array = realloc(*arrays[i], sizeof (uint32_t) * capacity);
+
+        if (array == NULL) {
+            fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+            exit(EXIT_FAILURE);
+        }
+
+        for (size_t j = automaton->state_count; j < capacity; ++j) {
+            array[j] = AHO_CORASICK_NONE;
+        }
+
+        *arrays[i] = array;
+    }
+
+    automaton->state_count = capacity;
+}
+
+/**
+ * Double-Array Free List
+ *
+ * The free positions of the double array, in a doubly
+ * linked list in increasing order, so that placing a state
+ * only considers bases that put its first child on a free
+ * position, however full the array is. The list also
+ * counts the failed attempts at each position, and a
+ * position retired from the list points back to itself.
+ *
+ * @struct double_array_free_list_t
+ *
+ */
+typedef struct {
+    uint32_t* next;
+    uint32_t* previous;
+    unsigned char* attempts;
+    uint32_t head;
+    uint32_t tail;
+    size_t capacity;
+} double_array_free_list_t;
+
+/**
+ * Extend Double-Array Free List
+ *
+ * This function appends the positions the double array has
+ * gained since the list last saw it, all of which are free.
+ *
+ */
+static void extend_double_array_free_list(double_array_free_list_t* list, const aho_corasick_automaton_t* automaton) {
+    const size_t capacity = automaton->state_count;
+
+    if (capacity <= list->capacity) {
+        return;
+    }
+
+    list->next = realloc(list->next, sizeof (uint32_t) * capacity);
+    list->previous = realloc(list->previous, sizeof (uint32_t) * capacity);
+    list->attempts = realloc(list->attempts, sizeof (unsigned char) * capacity);
+
+    if ((list->next == NULL) || (list->previous == NULL) || (list->attempts == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t t = list->capacity; t < capacity; ++t) {
+        if (automaton->check[t] != AHO_CORASICK_NONE) {
+            continue;
+        }
+
+        list->previous[t] = list->tail;
+        list->next[t] = AHO_CORASICK_NONE;
+        list->attempts[t] = 0;
+
+        if (list->tail == AHO_CORASICK_NONE) {
+            list->head = (uint32_t) t;
+        } else {
+            list->next[list->tail] = (uint32_t) t;
+        }
+
+        list->tail = (uint32_t) t;
+    }
+
+    list->capacity = capacity;
+}
+
+/**
+ * Take Double-Array Position
+ *
+ * This function removes a position from the free list, if
+ * it has not been retired from it already.
+ *
+ */
+static void take_double_array_position(double_array_free_list_t* list, uint32_t t) {
+    if (list->next[t] == t) {
+        return;
+    }
+
+    const uint32_t next = list->next[t];
+    const uint32_t previous = list->previous[t];
+
+    if (previous == AHO_CORASICK_NONE) {
+        list->head = next;
+    } else {
+        list->next[previous] = next;
+    }
+
+    if (next == AHO_CORASICK_NONE) {
+        list->tail = previous;
+    } else {
+        list->previous[next] = previous;
+    }
+
+    list->next[t] = t;
+    list->previous[t] = t;
+}
+
+/**
+ * Find Double-Array Base
+ *
+ * This function finds a base at which every child of a
+ * state lands on a free position. Only bases putting the
+ * smallest label on a position from the free list are
+ * tried; positions past the end of the array count as free,
+ * since the array is grown to hold them once the base is
+ * chosen. Positions that keep failing are retired from the
+ * list.
+ *
+ * @param[in] automaton The automaton being built.
+ * @param[in,out] list The free positions of its double array.
+ * @param[in] labels The labels of the children, in increasing order.
+ * @param[in] children The number of children.
+ *
+ * @returns The base, which is never zero.
+ *
+ */
+static size_t find_double_array_base(const aho_corasick_automaton_t* automaton, double_array_free_list_t* list, const unsigned char* labels, size_t children) {
+    const size_t size = automaton->state_count;
+
+    uint32_t next = AHO_CORASICK_NONE;
+
+    for (uint32_t t = list->head; t != AHO_CORASICK_NONE; t = next) {
+        next = list->next[t];
+
+        /** The base must be positive, since zero marks a state without children. */
+        if (t > labels[0]) {
+            const size_t base = t - labels[0];
+
+            size_t k = 1;
+
+            while ((k < children) && ((base + labels[k] >= size) || (automaton->check[base + labels[k]] == AHO_CORASICK_NONE))) {
+                k += 1;
+            }
+
+            if (k == children) {
+                return base;
+            }
+        }
+
+        if (++list->attempts[t] == AHO_CORASICK_PLACEMENT_ATTEMPTS) {
+            take_double_array_position(list, t);
+        }
+    }
+
+    return size - labels[0];
+}
+
+/**
+ * Build Double-Array Automaton
+ *
+ * This function lays the goto function of the trie out as a
+ * double array. The children of the state at position s
+ * occupy positions base[s] + c for each of their labels c,
+ * and a position t holds a child of s if and only if
+ * check[t] is s. Each state's base is the first one, in the
+ * order of the free list, for which all of its children's
+ * positions are still free, so the children of different
+ * states interleave, and the arrays stay close to the
+ * number of trie nodes in size.
+ *
+ * Since the matcher looks up base[s] + c for every byte c,
+ * the array always extends 256 positions past the largest
+ * base.
+ *
+ * @cite aoe_efficient_1989
+ *
+ */
+static void build_double_array_automaton(aho_corasick_automaton_t* automaton, const aho_corasick_node_t* trie, size_t nodes, const uint32_t* order) {
+    uint32_t* position = allocate_automaton_memory(sizeof (uint32_t) * nodes);
+    unsigned char labels[256];
+
+    automaton->state_count = 0;
+    grow_double_array(automaton, nodes + 256);
+
+    /**
+     * The root lives at position zero. Its check entry is
+     * set to a value no state can have, so its position is
+     * never taken by a child.
+     *
+     */
+    position[0] = 0;
+    automaton->check[0] = AHO_CORASICK_NONE - 1;
+
+    double_array_free_list_t list = { NULL, NULL, NULL, AHO_CORASICK_NONE, AHO_CORASICK_NONE, 0 };
+
+    extend_double_array_free_list(&list, automaton);
+
+    for (size_t i = 0; i < nodes; ++i) {
+        const uint32_t node = order[i];
+        const uint32_t s = position[node];
+        size_t children = 0;
+
+        for (uint32_t child = trie[node].first_child; child != AHO_CORASICK_NONE; child = trie[child].next_sibling) {
+            size_t k = children++;
+
+            while ((k > 0) && (labels[k - 1] > trie[child].label)) {
+                labels[k] = labels[k - 1];
+                k -= 1;
+            }
+
+            labels[k] = trie[child].label;
+        }
+
+        automaton->output[s] = trie[node].output;
+
+        if (children == 0) {
+            automaton->base[s] = 0;
+            continue;
+        }
+
+        const size_t base = find_double_array_base(automaton, &list, labels, children);
+
+        grow_double_array(automaton, base + 256);
+        extend_double_array_free_list(&list, automaton);
+
+        automaton->base[s] = (uint32_t) base;
+
+        for (uint32_t child = trie[node].first_child; child != AHO_CORASICK_NONE; child = trie[child].next_sibling) {
+            position[child] = (uint32_t) (base + trie[child].label);
+            automaton->check[position[child]] = s;
+            take_double_array_position(&list, position[child]);
+        }
+    }
+
+    for (size_t node = 0; node < nodes; ++node) {
+        automaton->fail[position[node]] = position[trie[node].fail];
+        automaton->dictionary[position[node]] = (trie[node].dictionary == AHO_CORASICK_NONE) ? AHO_CORASICK_NONE : position[trie[node].dictionary];
+    }
+
+    free(list.next);
+    free(list.previous);
+    free(list.attempts);
+    free(position);
+}
+
+/**
+ * Build an Aho-Corasick automaton.
+ *
+ * @param[in] needles   The substrings to look for.
+ * @param[in] lengths   The lengths of the needles.
+ * @param[in] count     The number of needles.
+ *
+ * @returns Pointer to the automaton, which must be released
+ * using free_aho_corasick_automaton().
+ *
+ * @cite aho_efficient_1975
+ *
+ */
+aho_corasick_automaton_t* build_aho_corasick_automaton(const char* const* needles, const size_t* lengths, size_t count) {
+    aho_corasick_automaton_t* automaton = allocate_automaton_memory(sizeof (aho_corasick_automaton_t));
+
+    automaton->needle_count = count;
+    automaton->lengths = allocate_automaton_memory(sizeof (size_t) * (count + 1));
+    automaton->duplicates = allocate_automaton_memory(sizeof (uint32_t) * (count + 1));
+    automaton->state_count = 0;
+    automaton->output = NULL;
+    automaton->dictionary = NULL;
+    automaton->transitions = NULL;
+    automaton->base = NULL;
+    automaton->check = NULL;
+    automaton->fail = NULL;
+
+    if (count > 0) {
+        memcpy(automaton->lengths, lengths, sizeof (size_t) * count);
+    }
+
+    size_t nodes = 0;
+    uint32_t* order = NULL;
+    aho_corasick_node_t* trie = build_trie(needles, lengths, count, automaton->duplicates, &nodes, &order);
+
+    if (nodes <= AHO_CORASICK_DENSE_STATE_LIMIT) {
+        build_dense_automaton(automaton, trie, nodes, order);
+    } else {
+        build_double_array_automaton(automaton, trie, nodes, order);
+    }
+
+    free(order);
+    free(trie);
+
+    return automaton;
+}
+
+/**
+ * Report Aho-Corasick Outputs
+ *
+ * This function reports every needle ending at the given
+ * state, following its dictionary links.
+ *
+ * @returns Nonzero if the callback stopped the search.
+ *
+ */
+static inline int report_aho_corasick_outputs(const aho_corasick_automaton_t* automaton, uint32_t state, size_t end, pattern_set_match_callback_t callback, void* context, size_t* matches) {
+    if ((automaton->output[state] == AHO_CORASICK_NONE) && (automaton->dictionary[state] == AHO_CORASICK_NONE)) {
+        return 0;
+    }
+
+    for (; state != AHO_CORASICK_NONE; state = automaton->dictionary[state]) {
+        for (uint32_t needle = automaton->output[state]; needle != AHO_CORASICK_NONE; needle = automaton->duplicates[needle]) {
+            *matches += 1;
+
+            if (callback(needle, end - automaton->lengths[needle], context) != 0) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Run an Aho-Corasick automaton over a buffer.
+ *
+ * This function feeds every byte of the haystack to the
+ * automaton, reporting each match as soon as its last byte
+ * has been read, and therefore in order of increasing end
+ * offset. The automaton itself is never modified, so it may
+ * be run by any number of threads at once.
+ *
+ * @param[in] automaton The automaton to run.
+ * @param[in] haystack  The buffer to look in.
+ * @param[in] h         The length of the haystack.
+ * @param[in] callback  The function to report matches to.
+ * @param[in] context   User-supplied pointer passed to the callback.
+ *
+ * @returns The number of matches reported to the callback.
+ *
+ * @cite aho_efficient_1975
+ *
+ */
+size_t run_aho_corasick_automaton(const aho_corasick_automaton_t* automaton, const char* haystack, size_t h, pattern_set_match_callback_t callback, void* context) {
+    size_t matches = 0;
+    uint32_t state = 0;
+
+    if (automaton->transitions != NULL) {
+        const uint32_t* transitions = automaton->transitions;
+
+        for (size_t i = 0; i < h; ++i) {
+            state = transitions[((size_t) state * 256) + (unsigned char) haystack[i]];
+
+            if (report_aho_corasick_outputs(automaton, state, i + 1, callback, context, &matches) != 0) {
+                break;
+            }
+        }
+
+        return matches;
+    }
+
+    const uint32_t* base = automaton->base;
+    const uint32_t* check = automaton->check;
+    const uint32_t* fail = automaton->fail;
+
+    for (size_t i = 0; i < h; ++i) {
+        const unsigned char c = (unsigned char) haystack[i];
+
+        for (;;) {
+            const uint32_t next = base[state] + c;
+
+            if ((base[state] != 0) && (check[next] == state)) {
+                state = next;
+                break;
+            }
+
+            if (state == 0) {
+                break;
+            }
+
+            state = fail[state];
+        }
+
+        if (report_aho_corasick_outputs(automaton, state, i + 1, callback, context, &matches) != 0) {
+            break;
+        }
+    }
+
+    return matches;
+}
+
+/**
+ * Free an Aho-Corasick automaton.
+ *
+ * @param[in] automaton The automaton to free. May be NULL.
+ *
+ */
+void free_aho_corasick_automaton(aho_corasick_automaton_t* automaton) {
+    if (automaton == NULL) {
+        return;
+    }
+
+    free(automaton->lengths);
+    free(automaton->duplicates);
+    free(automaton->output);
+    free(automaton->dictionary);
+    free(automaton->transitions);
+    free(automaton->base);
+    free(automaton->check);
+    free(automaton->fail);
+    free(automaton);
+}
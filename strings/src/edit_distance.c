@@ -40,152 +40,1143 @@
 #define MIN(a,b) ((a > b) ? (b) : (a))
 #endif
 
-static size_t min3(size_t a, size_t b, size_t c) {
-    size_t minimum = MIN(a,b);
-    return MIN(minimum,c);
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+
+/**
+ * This macro is defined when the vectorized implementations
+ * of the Hamming distance are available.
+ *
+ * @def XLIBS_HAMMING_DISTANCE_SIMD
+ *
+ */
+#define XLIBS_HAMMING_DISTANCE_SIMD
+#endif
+
+/**
+ * Edit Distance Workspace
+ *
+ * The workspace is a single buffer, grown on demand, from
+ * which the edit distance calculations carve their scratch
+ * memory. Its contents do not persist between calls, so
+ * growing it never needs to copy them.
+ *
+ */
+struct edit_distance_workspace {
+    void* buffer;
+    size_t capacity;
+};
+
+/**
+ * Reserve Edit Distance Workspace
+ *
+ * @param[in,out] workspace The workspace to reserve memory from.
+ * @param[in] size The number of bytes required.
+ *
+ * @returns A pointer to at least size bytes of scratch
+ * memory, suitably aligned for any type, and valid until the
+ * next reservation from the same workspace.
+ *
+ */
+void* reserve_edit_distance_workspace(edit_distance_workspace_t* workspace, size_t size) {
+    if (size > workspace->capacity) {
+        free(workspace->buffer);
+
+        workspace->buffer = malloc(size);
+        workspace->capacity = size;
+
+        if (workspace->buffer == NULL) {
+            fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return workspace->buffer;
+}
+
+/**
+ * Strip Common Affixes
+ *
+ * The characters shared by the beginning or the end of both
+ * strings never contribute to their edit distance, so they
+ * are removed before doing any real work.
+ *
+ * @param[in,out] a The first string to compare.
+ * @param[in,out] m The length of a.
+ * @param[in,out] b The second string to compare.
+ * @param[in,out] n The length of b.
+ *
+ */
+static void strip_common_affixes(const char** a, size_t* m, const char** b, size_t* n) {
+    size_t prefix = 0;
+
+    while ((prefix < *m) && (prefix < *n) && ((*a)[prefix] == (*b)[prefix])) {
+        ++prefix;
+    }
+
+    *a += prefix;
+    *b += prefix;
+    *m -= prefix;
+    *n -= prefix;
+
+    while ((*m > 0) && (*n > 0) && ((*a)[*m - 1] == (*b)[*n - 1])) {
+        --(*m);
+        --(*n);
+    }
+}
+
+/**
+ * Order By Length
+ *
+ * The symmetric distances are computed with the shorter
+ * string along the columns of the dynamic programming
+ * matrix, so the two strings are swapped if need be to
+ * make a the shorter one.
+ *
+ * @param[in,out] a The first string to compare.
+ * @param[in,out] m The length of a.
+ * @param[in,out] b The second string to compare.
+ * @param[in,out] n The length of b.
+ *
+ */
+static void order_by_length(const char** a, size_t* m, const char** b, size_t* n) {
+    if (*m > *n) {
+        const char* swap = *a;
+        *a = *b;
+        *b = swap;
+
+        const size_t swap_length = *m;
+        *m = *n;
+        *n = swap_length;
+    }
+}
+
+/**
+ * Build Levenshtein Match Masks
+ *
+ * The bit-parallel Levenshtein algorithms encode the string
+ * laid along the columns of the dynamic programming matrix
+ * by the match mask of each byte value, Peq, which has the
+ * bits set for the positions of the string holding that
+ * byte. The masks are split into blocks of 64 positions,
+ * and the blocks of each byte value are contiguous.
+ *
+ * @param[out] peq The 256 * blocks words to store the masks in.
+ * @param[in] blocks The number of 64-bit blocks per mask.
+ * @param[in] a The string to encode, of at most 64 * blocks characters.
+ * @param[in] m The length of a.
+ *
+ */
+void build_levenshtein_match_masks(uint64_t* peq, size_t blocks, const char* a, size_t m) {
+    memset(peq, 0, sizeof (uint64_t) * 256 * blocks);
+
+    for (size_t i = 0; i < m; ++i) {
+        peq[((size_t) (unsigned char) a[i] * blocks) + (i / 64)] |= (uint64_t) 1 << (i % 64);
+    }
+}
+
+/**
+ * Levenshtein Distance (Single Word)
+ *
+ * This function computes the Levenshtein distance using
+ * the bit-parallel algorithm of Myers, in the formulation
+ * given by Hyyro. Each column of the dynamic programming
+ * matrix is encoded by the bit vectors of its positive and
+ * negative vertical deltas, one bit per character of a, so
+ * a whole column is computed with a handful of word-wide
+ * operations.
+ *
+ * @param[in] peq The match masks of a, in a single block.
+ * @param[in] m The length of a, between 1 and 64.
+ * @param[in] b The second string to compare.
+ * @param[in] n The length of b.
+ *
+ * @returns The Levenshtein distance between a and b.
+ *
+ * @cite myers_fast_1999
+ * @cite hyyro_bit-parallel_2001
+ *
+ */
+size_t run_levenshtein_single_word(const uint64_t* peq, size_t m, const char* b, size_t n) {
+    const uint64_t last = (uint64_t) 1 << (m - 1);
+
+    uint64_t vp = ~(uint64_t) 0;
+    uint64_t vn = 0;
+    size_t score = m;
+
+    for (size_t j = 0; j < n; ++j) {
+        const uint64_t eq = peq[(unsigned char) b[j]];
+        const uint64_t xv = eq | vn;
+        const uint64_t xh = (((eq & vp) + vp) ^ vp) | eq;
+
+        uint64_t hp = vn | ~(xh | vp);
+        uint64_t hn = vp & xh;
+
+        score += ((hp & last) != 0);
+        score -= ((hn & last) != 0);
+
+        hp = (hp << 1) | 1;
+        hn = hn << 1;
+
+        vp = hn | ~(xv | hp);
+        vn = hp & xv;
+    }
+
+    return score;
+}
+
+/**
+ * Levenshtein Distance (Blocked)
+ *
+ * This function extends the single word algorithm to
+ * strings of any length by splitting each column into
+ * blocks of 64 characters. Each block is advanced as in the
+ * single word case, except that the horizontal delta
+ * entering its first row is the one leaving the last row of
+ * the block above it, rather than the constant +1 of the
+ * first row of the matrix. The time taken is
+ * \f$O\left(\lceil m/64 \rceil n\right)\f$.
+ *
+ * @param[in] peq The match masks of a.
+ * @param[in] blocks The number of 64-bit blocks per mask.
+ * @param[out] vp Scratch space for the positive deltas, of blocks words.
+ * @param[out] vn Scratch space for the negative deltas, of blocks words.
+ * @param[in] m The length of a, at least 1.
+ * @param[in] b The second string to compare.
+ * @param[in] n The length of b.
+ *
+ * @returns The Levenshtein distance between a and b.
+ *
+ * @cite hyyro_bit-parallel_2003
+ *
+ */
+size_t run_levenshtein_blocked(const uint64_t* peq, size_t blocks, uint64_t* vp, uint64_t* vn, size_t m, const char* b, size_t n) {
+    for (size_t k = 0; k < blocks; ++k) {
+        vp[k] = ~(uint64_t) 0;
+        vn[k] = 0;
+    }
+
+    const uint64_t last = (uint64_t) 1 << ((m - 1) % 64);
+    size_t score = m;
+
+    for (size_t j = 0; j < n; ++j) {
+        const uint64_t* eqs = peq + ((size_t) (unsigned char) b[j] * blocks);
+
+        /** The first row of the matrix always increases by one. */
+        int carry = 1;
+
+        for (size_t k = 0; k < blocks; ++k) {
+            uint64_t eq = eqs[k];
+            const uint64_t xv = eq | vn[k];
+
+            if (carry < 0) {
+                eq |= 1;
+            }
+
+            const uint64_t xh = (((eq & vp[k]) + vp[k]) ^ vp[k]) | eq;
+
+            uint64_t hp = vn[k] | ~(xh | vp[k]);
+            uint64_t hn = vp[k] & xh;
+
+            const uint64_t out = (k + 1 < blocks) ? ((uint64_t) 1 << 63) : last;
+            const int next = ((hp & out) != 0) ? 1 : (((hn & out) != 0) ? -1 : 0);
+
+            hp <<= 1;
+            hn <<= 1;
+
+            if (carry < 0) {
+                hn |= 1;
+            } else if (carry > 0) {
+                hp |= 1;
+            }
+
+            vp[k] = hn | ~(xv | hp);
+            vn[k] = hp & xv;
+
+            carry = next;
+        }
+
+        score += (size_t) carry;
+    }
+
+    return score;
 }
 
 /**
  * Calculate the Levenshtein distance between the strings
  * represented by a and b.
  *
- * The current implementation uses the Fischer-Wagner
- * algorithm to calculate the Levenshtein distance between
- * the two strings.
+ * After stripping the common prefix and suffix of the two
+ * strings, the shorter one is encoded as a bit vector, and
+ * the distance is computed with Myers' bit-parallel
+ * algorithm, using a single machine word if the shorter
+ * string fits in one, and blocks of words otherwise. The
+ * memory taken is one bit per character of the shorter
+ * string for each of the 258 bit vectors, drawn from the
+ * workspace rather than the stack.
  *
+ * @param[in,out] workspace The workspace to draw scratch memory from.
  * @param[in] a The first string to compare.
+ * @param[in] a_length The length of a.
  * @param[in] b The second string to compare.
+ * @param[in] b_length The length of b.
  *
  * @returns The edit distance between a and b , as defined
  * by the Levenshtein distance between them.
  *
- * @todo Implement this function.
- * @todo Write the man page for this function.
- * @todo Implement a more efficient version of this
- * algorithm. The current version has a time and memory
- * complexity of O(n*m).
- *
  */
 static size_t
-__attribute__((nonnull(1,2)))
-calculate_levenshtein_distance(const char* a, const char* b) {
-    size_t m = strlen(a) + 1;
-    size_t n = strlen(b) + 1;
+__attribute__((nonnull(1,2,4)))
+levenshtein_distance(edit_distance_workspace_t* workspace, const char* a, size_t a_length, const char* b, size_t b_length) {
+    strip_common_affixes(&a, &a_length, &b, &b_length);
+
+    order_by_length(&a, &a_length, &b, &b_length);
+
+    if (a_length == 0) {
+        return b_length;
+    }
+
+    if (a_length <= 64) {
+        uint64_t peq[256];
+
+        build_levenshtein_match_masks(peq, 1, a, a_length);
+
+        return run_levenshtein_single_word(peq, a_length, b, b_length);
+    }
+
+    const size_t blocks = (a_length + 63) / 64;
+
+    uint64_t* peq = reserve_edit_distance_workspace(workspace, sizeof (uint64_t) * 258 * blocks);
+
+    build_levenshtein_match_masks(peq, blocks, a, a_length);
+
+    return run_levenshtein_blocked(peq, blocks, peq + (256 * blocks), peq + (257 * blocks), a_length, b, b_length);
+}
+
+/**
+ * Calculate the Levenshtein distance between two strings,
+ * up to a bound.
+ *
+ * This function implements Ukkonen's banded algorithm. If
+ * the longer string b exceeds the shorter string a by
+ * \f$\delta\f$ characters, any alignment with cost at most k
+ * stays within the diagonals \f$j - i \in \left[-p, \delta + p\right]\f$
+ * of the matrix, where \f$p = \lfloor\left(k - \delta\right)/2\rfloor\f$,
+ * since every step away from the main diagonal must later
+ * be undone. Only those at most k+1 diagonals are computed,
+ * and the cells outside them are treated as exceeding k.
+ *
+ * The band is stored as a single array indexed by diagonal.
+ * Moving down a row keeps a cell on its diagonal, so the
+ * cells above, to the left, and above-left of each cell are
+ * respectively the next, previous, and same entry of the
+ * array, and a row can be updated in place.
+ *
+ * After each row, the smallest value in the band, plus the
+ * number of insertions or deletions still needed to reach
+ * the last diagonal from it, is a lower bound on the final
+ * distance, so the computation stops once it exceeds k.
+ *
+ * @param[in,out] workspace The workspace holding the band.
+ * @param[in] a The first string to compare.
+ * @param[in] a_length The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] b_length The length of b.
+ * @param[in] max The largest distance of interest.
+ *
+ * @returns The Levenshtein distance between a and b if it
+ * is at most max, and EDIT_DISTANCE_EXCEEDED otherwise.
+ *
+ * @cite ukkonen_algorithms_1985
+ *
+ */
+static size_t bounded_levenshtein_distance(edit_distance_workspace_t* workspace, const char* a, size_t a_length, const char* b, size_t b_length, size_t max) {
+    strip_common_affixes(&a, &a_length, &b, &b_length);
+
+    order_by_length(&a, &a_length, &b, &b_length);
+
+    const size_t m = a_length;
+    const size_t n = b_length;
+    const size_t delta = n - m;
+
+    if (delta > max) {
+        return EDIT_DISTANCE_EXCEEDED;
+    }
 
     /**
-     * For all \f$i\f$ and \f$j\f$, the value \f$\text{distance}\left[i\right]\left[j\right]\f$
-     * will hold the Levenshtein distance between the first
-     * \f$i\f$ characters of a and the first \f$j\f$
-     * characters of b.
+     * The distance never exceeds the length of the longer
+     * string, so a bound at least that large constrains
+     * nothing, and the unbounded algorithm is faster.
      *
      */
-    size_t d[m][n];// = { 0 };
-    
-    for (size_t i = 0; i < m; ++i) {
-        for (size_t j = 0; j < n; ++j) {
-            d[i][j] = 0;
-        }
+    if ((m == 0) || (max >= n)) {
+        return levenshtein_distance(workspace, a, m, b, n);
     }
 
+    const size_t k = max;
+    const size_t infinity = k + 1;
+    const size_t p = (k - delta) / 2;
+    const size_t width = delta + (2 * p) + 1;
+
     /**
-     * Source prefixes can be transformed into the empty
-     * string by dropping all characters.
+     * The band has a sentinel cell at either end, so that
+     * the neighbors of its outermost diagonals need not be
+     * special-cased.
      *
      */
-    for (size_t i = 0; i < m; ++i) {
-        for (size_t j = 0; j < n; ++j) {
-            if (j == 0) {
-                d[i][j] = i;
+    size_t* band = reserve_edit_distance_workspace(workspace, sizeof (size_t) * (width + 2));
+
+    band[0] = infinity;
+    band[width + 1] = infinity;
+
+    /** The first row is the cost of inserting each prefix of b. */
+    for (size_t d = 0; d < width; ++d) {
+        band[d + 1] = ((d >= p) && (d - p <= n)) ? MIN(d - p, infinity) : infinity;
+    }
+
+    for (size_t i = 1; i <= m; ++i) {
+        size_t lower_bound = infinity;
+
+        for (size_t d = 0; d < width; ++d) {
+            size_t value = infinity;
+
+            /** Column j = i + d - p, when it is within the matrix. */
+            if (i + d >= p) {
+                const size_t j = i + d - p;
+
+                if (j == 0) {
+                    value = MIN(i, infinity);
+                } else if (j <= n) {
+                    const size_t substitution = band[d + 1] + ((a[i - 1] == b[j - 1]) ? 0 : 1);
+                    const size_t deletion = band[d + 2] + 1;
+                    const size_t insertion = band[d] + 1;
+
+                    value = MIN(MIN(substitution, deletion), MIN(insertion, infinity));
+                }
+
+                /** Cells right of the last column remain infinite. */
+                if ((j <= n) && (value < infinity)) {
+                    const size_t remaining = (d < p) ? delta + (p - d) : ((delta > d - p) ? delta - (d - p) : (d - p) - delta);
+
+                    lower_bound = MIN(lower_bound, value + remaining);
+                }
             }
+
+            band[d + 1] = value;
+        }
+
+        if (lower_bound > k) {
+            return EDIT_DISTANCE_EXCEEDED;
         }
     }
 
+    return (band[delta + p + 1] <= k) ? band[delta + p + 1] : EDIT_DISTANCE_EXCEEDED;
+}
+
+/**
+ * Calculate the Levenshtein distance between the strings
+ * represented by a and b.
+ *
+ * This is the adapter of levenshtein_distance() to the
+ * edit_distance_function_t interface, using a workspace
+ * that lasts only for the duration of the call.
+ *
+ * @param[in] a The first string to compare.
+ * @param[in] a_length The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] b_length The length of b.
+ *
+ * @returns The edit distance between a and b , as defined
+ * by the Levenshtein distance between them.
+ *
+ * @todo Write the man page for this function.
+ *
+ */
+static size_t calculate_levenshtein_distance(const char* a, size_t a_length, const char* b, size_t b_length) {
+    edit_distance_workspace_t workspace = { NULL, 0 };
+
+    const size_t distance = levenshtein_distance(&workspace, a, a_length, b, b_length);
+
+    free(workspace.buffer);
+
+    return distance;
+}
+
+/**
+ * Advance Longest Common Subsequence
+ *
+ * This function advances the bit vector of the algorithm
+ * of Allison and Dix, in the formulation of Hyyro, by one
+ * character of the text. Bit i of the vector is clear when
+ * the length of the longest common subsequence of the text
+ * so far and the first i + 1 characters of the pattern
+ * exceeds that for the first i characters. Given the match
+ * mask M of the text character, the vector V becomes
+ * \f$\left(V + \left(V \land M\right)\right) \lor \left(V \land \lnot M\right)\f$,
+ * where the addition carries across the words of the
+ * vector. No subtraction borrows across words, since
+ * \f$V - \left(V \land M\right) = V \land \lnot M\f$.
+ *
+ * @param[in,out] v The bit vector, of blocks words.
+ * @param[in] mask The match mask of the text character.
+ * @param[in] blocks The number of 64-bit blocks of the vector.
+ *
+ * @cite allison_bit-string_1986
+ * @cite hyyro_bit-parallel_2004
+ *
+ */
+static inline void advance_longest_common_subsequence(uint64_t* v, const uint64_t* mask, size_t blocks) {
+    uint64_t carry = 0;
+
+    for (size_t k = 0; k < blocks; ++k) {
+        const uint64_t u = v[k] & mask[k];
+        const uint64_t sum = v[k] + u + carry;
+
+        carry = (sum < v[k]) || ((carry != 0) && (sum == v[k]));
+
+        v[k] = sum | (v[k] & ~mask[k]);
+    }
+}
+
+/**
+ * Count Longest Common Subsequence
+ *
+ * @param[in] v The bit vector of the algorithm.
+ * @param[in] m The length of the pattern.
+ *
+ * @returns The length of the longest common subsequence,
+ * the number of clear bits among the first m bits of v.
+ *
+ */
+static size_t count_longest_common_subsequence(const uint64_t* v, size_t m) {
+    size_t length = 0;
+
+    for (size_t k = 0; k < m / 64; ++k) {
+        length += (size_t) __builtin_popcountll(~v[k]);
+    }
+
+    if (m % 64 != 0) {
+        length += (size_t) __builtin_popcountll(~v[m / 64] & (((uint64_t) 1 << (m % 64)) - 1));
+    }
+
+    return length;
+}
+
+/**
+ * Calculate the length of the longest common subsequence
+ * of the strings represented by a and b.
+ *
+ * After stripping the common prefix and suffix of the two
+ * strings, which belong to every longest common
+ * subsequence, the shorter string is encoded by its match
+ * masks, and the longer one is scanned a character at a
+ * time, taking \f$\lceil m/64 \rceil\f$ word operations per
+ * character and no table proportional to \f$m n\f$.
+ *
+ * @param[in,out] workspace The workspace to draw scratch memory from.
+ * @param[in] a The first string to compare.
+ * @param[in] a_length The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] b_length The length of b.
+ *
+ * @returns The length of the longest common subsequence of
+ * a and b.
+ *
+ */
+static size_t longest_common_subsequence(edit_distance_workspace_t* workspace, const char* a, size_t a_length, const char* b, size_t b_length) {
+    const size_t original_length = a_length;
+
+    strip_common_affixes(&a, &a_length, &b, &b_length);
+
+    const size_t affixes = original_length - a_length;
+
+    order_by_length(&a, &a_length, &b, &b_length);
+
+    if (a_length == 0) {
+        return affixes;
+    }
+
+    if (a_length <= 64) {
+        uint64_t peq[256];
+
+        build_levenshtein_match_masks(peq, 1, a, a_length);
+
+        uint64_t v = ~(uint64_t) 0;
+
+        for (size_t j = 0; j < b_length; ++j) {
+            const uint64_t u = v & peq[(unsigned char) b[j]];
+
+            v = (v + u) | (v - u);
+        }
+
+        return affixes + count_longest_common_subsequence(&v, a_length);
+    }
+
+    const size_t blocks = (a_length + 63) / 64;
+
+    uint64_t* peq = reserve_edit_distance_workspace(workspace, sizeof (uint64_t) * 257 * blocks);
+    uint64_t* v = peq + (256 * blocks);
+
+    build_levenshtein_match_masks(peq, blocks, a, a_length);
+
+    for (size_t k = 0; k < blocks; ++k) {
+        v[k] = ~(uint64_t) 0;
+    }
+
+    for (size_t j = 0; j < b_length; ++j) {
+        advance_longest_common_subsequence(v, peq + ((size_t) (unsigned char) b[j] * blocks), blocks);
+    }
+
+    return affixes + count_longest_common_subsequence(v, a_length);
+}
+
+/**
+ * Calculate the longest common subsequence between the
+ * strings represented by a and b.
+ *
+ * @see longest_common_subsequence()
+ *
+ * @todo Write the man page for this function.
+ *
+ */
+static size_t calculate_longest_common_subsequence_distance(const char* a, size_t a_length, const char* b, size_t b_length) {
+    edit_distance_workspace_t workspace = { NULL, 0 };
+
+    const size_t length = longest_common_subsequence(&workspace, a, a_length, b, b_length);
+
+    free(workspace.buffer);
+
+    return length;
+}
+
+/**
+ * Count Byte Matches (Generic)
+ *
+ * This function counts the positions at which two buffers
+ * of the same length hold the same byte.
+ *
+ * @param[in] a The first buffer to compare.
+ * @param[in] b The second buffer to compare.
+ * @param[in] n The length of both buffers.
+ *
+ * @returns The number of matching positions.
+ *
+ */
+static size_t count_byte_matches_generic(const char* a, const char* b, size_t n) {
+    size_t matches = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        matches += (a[i] == b[i]);
+    }
+
+    return matches;
+}
+
+#ifdef XLIBS_HAMMING_DISTANCE_SIMD
+
+/**
+ * Count Byte Matches (SSE2)
+ *
+ * This function compares the buffers a vector at a time.
+ * The all-ones bytes of each comparison are subtracted from
+ * a vector of byte counters, so that every lane counts the
+ * matches at its position, and the counters are summed with
+ * a sum of absolute differences before any of them can
+ * overflow, once every 255 vectors.
+ *
+ * @see count_byte_matches_generic()
+ *
+ */
+__attribute__((target("sse2")))
+static size_t count_byte_matches_sse2(const char* a, const char* b, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t matches = 0;
+    size_t i = 0;
+
+    while (i + 16 <= n) {
+        const size_t vectors = MIN((n - i) / 16, (size_t) 255);
+
+        __m128i counters = zero;
+
+        for (size_t v = 0; v < vectors; ++v, i += 16) {
+            const __m128i x = _mm_loadu_si128((const __m128i*) (a + i));
+            const __m128i y = _mm_loadu_si128((const __m128i*) (b + i));
+
+            counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(x, y));
+        }
+
+        const __m128i sums = _mm_sad_epu8(counters, zero);
+
+        matches += (size_t) _mm_cvtsi128_si64(sums) + (size_t) _mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+    }
+
+    return matches + count_byte_matches_generic(a + i, b + i, n - i);
+}
+
+/**
+ * Count Byte Matches (AVX2)
+ *
+ * @see count_byte_matches_sse2()
+ *
+ */
+__attribute__((target("avx2")))
+static size_t count_byte_matches_avx2(const char* a, const char* b, size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t matches = 0;
+    size_t i = 0;
+
+    while (i + 32 <= n) {
+        const size_t vectors = MIN((n - i) / 32, (size_t) 255);
+
+        __m256i counters = zero;
+
+        for (size_t v = 0; v < vectors; ++v, i += 32) {
+            const __m256i x = _mm256_loadu_si256((const __m256i*) (a + i));
+            const __m256i y = _mm256_loadu_si256((const __m256i*) (b + i));
+
+            counters = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(x, y));
+        }
+
+        const __m256i sums = _mm256_sad_epu8(counters, zero);
+
+        matches += (size_t) _mm256_extract_epi64(sums, 0) + (size_t) _mm256_extract_epi64(sums, 1);
+        matches += (size_t) _mm256_extract_epi64(sums, 2) + (size_t) _mm256_extract_epi64(sums, 3);
+    }
+
+    return matches + count_byte_matches_generic(a + i, b + i, n - i);
+}
+
+/**
+ * Count Byte Matches (AVX-512BW)
+ *
+ * The comparison yields a mask register rather than a
+ * vector, so the counters are updated with a masked
+ * subtraction.
+ *
+ * @see count_byte_matches_sse2()
+ *
+ */
+__attribute__((target("avx512f,avx512bw")))
+static size_t count_byte_matches_avx512bw(const char* a, const char* b, size_t n) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi8(1);
+
+    size_t matches = 0;
+    size_t i = 0;
+
+    while (i + 64 <= n) {
+        const size_t vectors = MIN((n - i) / 64, (size_t) 255);
+
+        __m512i counters = zero;
+
+        for (size_t v = 0; v < vectors; ++v, i += 64) {
+            const __m512i x = _mm512_loadu_si512((const void*) (a + i));
+            const __m512i y = _mm512_loadu_si512((const void*) (b + i));
+
+            counters = _mm512_mask_add_epi8(counters, _mm512_cmpeq_epi8_mask(x, y), counters, one);
+        }
+
+        matches += (size_t) _mm512_reduce_add_epi64(_mm512_sad_epu8(counters, zero));
+    }
+
+    return matches + count_byte_matches_generic(a + i, b + i, n - i);
+}
+
+#endif /** XLIBS_HAMMING_DISTANCE_SIMD */
+
+/**
+ * Count Byte Matches Function
+ *
+ * @typedef count_byte_matches_function_t
+ *
+ */
+typedef size_t (*count_byte_matches_function_t)(const char*, const char*, size_t);
+
+/**
+ * Get Count Byte Matches Function
+ *
+ * @returns The widest implementation of the byte match
+ * count supported by the host.
+ *
+ */
+static count_byte_matches_function_t get_count_byte_matches_function(void) {
+#ifdef XLIBS_HAMMING_DISTANCE_SIMD
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512bw")) {
+        return count_byte_matches_avx512bw;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return count_byte_matches_avx2;
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return count_byte_matches_sse2;
+    }
+#endif
+
+    return count_byte_matches_generic;
+}
+
+/**
+ * Calculate the Hamming distance between the strings
+ * represented by a and b.
+ *
+ * The Hamming distance is the number of positions at which
+ * two strings of the same length differ. Strings of
+ * different lengths are compared over the length of the
+ * shorter one, and every character of the longer one past
+ * that point counts as a difference, as though the shorter
+ * string were padded with a character found in neither.
+ *
+ * @param[in] a The first string to compare.
+ * @param[in] a_length The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] b_length The length of b.
+ *
+ * @returns The edit distance between a and b, as defined
+ * by the Hamming distance between them.
+ *
+ * @todo Write the man page for this function.
+ *
+ */
+static size_t calculate_hamming_distance(const char* a, size_t a_length, const char* b, size_t b_length) {
+    const size_t n = MIN(a_length, b_length);
+    const size_t padding = MAX(a_length, b_length) - n;
+
+    return n - get_count_byte_matches_function()(a, b, n) + padding;
+}
+
+/**
+ * Optimal String Alignment Distance (Single Word)
+ *
+ * This function extends the bit-parallel Levenshtein
+ * algorithm with Hyyro's transposition vector. A diagonal
+ * zero delta may also arise from transposing a[i-1..i] with
+ * b[j-1..j], which requires a[i] = b[j-1] and a[i-1] = b[j],
+ * and that the cell two rows and columns back did not
+ * already have a zero diagonal delta. Those positions are
+ * exactly the bits of
+ * \f$\left(\left(\lnot D0_{j-1} \land Peq_{b_j}\right) \ll 1\right) \land Peq_{b_{j-1}}\f$,
+ * which is merged into the diagonal deltas of each column.
+ *
+ * @param[in] peq The match masks of a, in a single block.
+ * @param[in] m The length of a, between 1 and 64.
+ * @param[in] b The second string to compare.
+ * @param[in] n The length of b.
+ *
+ * @returns The optimal string alignment distance between a and b.
+ *
+ * @cite hyyro_bit-vector_2002
+ *
+ */
+static size_t optimal_string_alignment_single_word(const uint64_t* peq, size_t m, const char* b, size_t n) {
+    const uint64_t last = (uint64_t) 1 << (m - 1);
+
+    uint64_t vp = ~(uint64_t) 0;
+    uint64_t vn = 0;
+    uint64_t d0 = 0;
+    uint64_t previous_eq = 0;
+    size_t score = m;
+
+    for (size_t j = 0; j < n; ++j) {
+        const uint64_t eq = peq[(unsigned char) b[j]];
+        const uint64_t transpositions = ((~d0 & eq) << 1) & previous_eq;
+
+        d0 = (((eq & vp) + vp) ^ vp) | eq | vn | transpositions;
+
+        uint64_t hp = vn | ~(d0 | vp);
+        uint64_t hn = vp & d0;
+
+        score += ((hp & last) != 0);
+        score -= ((hn & last) != 0);
+
+        hp = (hp << 1) | 1;
+        hn = hn << 1;
+
+        vp = hn | ~(d0 | hp);
+        vn = hp & d0;
+
+        previous_eq = eq;
+    }
+
+    return score;
+}
+
+/**
+ * Optimal String Alignment Distance (Three Rows)
+ *
+ * This function computes the optimal string alignment
+ * distance with the classic dynamic programming recurrence,
+ * which adds to that of the Levenshtein distance the cost
+ * of transposing two adjacent characters from the cell two
+ * rows and columns back. Only the last three rows of the
+ * matrix are kept.
+ *
+ * @param[in,out] workspace The workspace holding the rows.
+ * @param[in] a The first string to compare.
+ * @param[in] m The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] n The length of b.
+ *
+ * @returns The optimal string alignment distance between a and b.
+ *
+ */
+static size_t optimal_string_alignment_rows(edit_distance_workspace_t* workspace, const char* a, size_t m, const char* b, size_t n) {
+    size_t* rows = reserve_edit_distance_workspace(workspace, sizeof (size_t) * 3 * (m + 1));
+
+    size_t* before = rows;
+    size_t* previous = rows + (m + 1);
+    size_t* current = rows + (2 * (m + 1));
+
+    for (size_t i = 0; i <= m; ++i) {
+        previous[i] = i;
+    }
+
+    for (size_t j = 1; j <= n; ++j) {
+        current[0] = j;
+
+        for (size_t i = 1; i <= m; ++i) {
+            const size_t substitution = previous[i - 1] + ((a[i - 1] == b[j - 1]) ? 0 : 1);
+
+            size_t value = MIN(substitution, MIN(previous[i], current[i - 1]) + 1);
+
+            if ((i > 1) && (j > 1) && (a[i - 1] == b[j - 2]) && (a[i - 2] == b[j - 1])) {
+                value = MIN(value, before[i - 2] + 1);
+            }
+
+            current[i] = value;
+        }
+
+        size_t* rotate = before;
+        before = previous;
+        previous = current;
+        current = rotate;
+    }
+
+    return previous[m];
+}
+
+/**
+ * Calculate the optimal string alignment distance between
+ * the strings represented by a and b.
+ *
+ * The optimal string alignment distance, also known as the
+ * restricted Damerau-Levenshtein distance, counts the
+ * transposition of two adjacent characters as a single
+ * edit, but does not allow a substring to be edited more
+ * than once. After stripping the common prefix and suffix,
+ * strings fitting in a machine word use the bit-parallel
+ * algorithm, and longer ones the three-row recurrence.
+ *
+ * @param[in,out] workspace The workspace to draw scratch memory from.
+ * @param[in] a The first string to compare.
+ * @param[in] a_length The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] b_length The length of b.
+ *
+ * @returns The optimal string alignment distance between a and b.
+ *
+ */
+static size_t optimal_string_alignment_distance(edit_distance_workspace_t* workspace, const char* a, size_t a_length, const char* b, size_t b_length) {
+    strip_common_affixes(&a, &a_length, &b, &b_length);
+    order_by_length(&a, &a_length, &b, &b_length);
+
+    if (a_length == 0) {
+        return b_length;
+    }
+
+    if (a_length <= 64) {
+        uint64_t peq[256];
+
+        build_levenshtein_match_masks(peq, 1, a, a_length);
+
+        return optimal_string_alignment_single_word(peq, a_length, b, b_length);
+    }
+
+    return optimal_string_alignment_rows(workspace, a, a_length, b, b_length);
+}
+
+/**
+ * Calculate the Damerau-Levenshtein distance between the
+ * strings represented by a and b.
+ *
+ * The unrestricted Damerau-Levenshtein distance of Lowrance
+ * and Wagner also counts transpositions of characters that
+ * are separated by further edits. Their recurrence looks
+ * back, for each cell, to the last row k in which a[k]
+ * equals b[j] and the last column l in which b[l] equals
+ * a[i], at a cost of the cell diagonally before (k, l) plus
+ * the characters in between. Such a transposition can only
+ * be optimal if either k = i - 1 or l = j - 1, so, as shown
+ * by Zhao and Sahni, it suffices to remember, for each
+ * column, the cell diagonally before the last match in
+ * that column, and, for the current row, the cell
+ * diagonally before its last match, along with the last
+ * row of each byte value. The memory taken is then linear
+ * in the length of b, with a table sized to the alphabet.
+ *
+ * Rows are numbered from 1, so that a last row of 0 stands
+ * for a byte not yet seen; the cells before the matrix are
+ * set to a value larger than any distance, so that such a
+ * row never yields a transposition.
+ *
+ * @param[in,out] workspace The workspace to draw scratch memory from.
+ * @param[in] a The first string to compare.
+ * @param[in] a_length The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] b_length The length of b.
+ *
+ * @returns The Damerau-Levenshtein distance between a and b.
+ *
+ * @cite lowrance_extension_1975
+ * @cite zhao_string_2019
+ *
+ */
+static size_t damerau_levenshtein_distance(edit_distance_workspace_t* workspace, const char* a, size_t a_length, const char* b, size_t b_length) {
+    strip_common_affixes(&a, &a_length, &b, &b_length);
+    order_by_length(&b, &b_length, &a, &a_length);
+
+    const size_t m = a_length;
+    const size_t n = b_length;
+
+    if (n == 0) {
+        return m;
+    }
+
+    const size_t infinity = m + 1;
+
     /**
-     * Target prefixes can be reached from an empty source
-     * prefix by inserting each character in succession.
+     * Each row has one more cell before its first column, so
+     * that the cell diagonally before the second column is
+     * always within the row.
      *
      */
-    for (size_t i = 0; i < m; ++i) {
-        for (size_t j = 0; j < n; ++j) {
-            if (i == 0) {
-                d[i][j] = j;
-            }
-        }
+    size_t* rows = reserve_edit_distance_workspace(workspace, sizeof (size_t) * 3 * (n + 2));
+
+    size_t* current = rows + 1;
+    size_t* previous = rows + (n + 2) + 1;
+    size_t* diagonals = rows + (2 * (n + 2)) + 1;
+
+    size_t last_row[256] = { 0 };
+
+    for (size_t j = 0; j <= n + 1; ++j) {
+        current[(ptrdiff_t) j - 1] = (j == 0) ? infinity : j - 1;
+        previous[(ptrdiff_t) j - 1] = infinity;
+        diagonals[(ptrdiff_t) j - 1] = infinity;
     }
 
-    for (size_t i = 1; i < m; ++i) {
-        for (size_t j = 1; j < n; ++j) {
-            size_t substitution_cost = ((a[i-1] == b[j-1]) ? 0 : 1);
-            d[i][j] = min3(d[i-1][j] + 1, d[i][j-1] + 1, d[i-1][j-1] + substitution_cost);
+    for (size_t i = 1; i <= m; ++i) {
+        size_t* swap = current;
+        current = previous;
+        previous = swap;
+
+        /** The current row now holds row i - 2. */
+        size_t last_column = 0;
+        size_t before_last = current[0];
+        size_t diagonal = infinity;
+
+        current[0] = i;
+
+        for (size_t j = 1; j <= n; ++j) {
+            const size_t substitution = previous[j - 1] + ((a[i - 1] == b[j - 1]) ? 0 : 1);
+
+            size_t value = MIN(substitution, MIN(previous[j], current[j - 1]) + 1);
+
+            if (a[i - 1] == b[j - 1]) {
+                last_column = j;
+                diagonals[j] = previous[(ptrdiff_t) j - 2];
+                diagonal = before_last;
+            } else {
+                const size_t k = last_row[(unsigned char) b[j - 1]];
+                const size_t l = last_column;
+
+                if (j - l == 1) {
+                    value = MIN(value, diagonals[j] + (i - k));
+                } else if (i - k == 1) {
+                    value = MIN(value, diagonal + (j - l));
+                }
+            }
+
+            before_last = current[j];
+            current[j] = value;
         }
+
+        last_row[(unsigned char) a[i - 1]] = i;
     }
 
-    // for (size_t i = 0; i < m; ++i) {
-    //     for (size_t j = 0; j < n; ++j) {
-    //         printf("%lu ", d[i][j]);
-    //     }
+    return current[n];
+}
+
+/**
+ * Calculate the optimal string alignment distance between
+ * the strings represented by a and b.
+ *
+ * @see optimal_string_alignment_distance()
+ *
+ */
+static size_t calculate_optimal_string_alignment_distance(const char* a, size_t a_length, const char* b, size_t b_length) {
+    edit_distance_workspace_t workspace = { NULL, 0 };
 
-    //     printf("\n");
-    // }
+    const size_t distance = optimal_string_alignment_distance(&workspace, a, a_length, b, b_length);
 
-    // printf("\n");
+    free(workspace.buffer);
 
-    return d[m-1][n-1];
+    return distance;
 }
 
 /**
- * Calculate the longest common subsequence between the
+ * Calculate the Damerau-Levenshtein distance between the
  * strings represented by a and b.
  *
- * @param[in] a The first string to compare.
- * @param[in] b The second string to compare.
- *
- * @returns The edit distance between a and b , as defined
- * by the length of the longest common subsequence between
- * them.
+ * @see damerau_levenshtein_distance()
  *
- * @todo Implement this function.
  * @todo Write the man page for this function.
  *
  */
-static size_t calculate_longest_common_subsequence_distance(const char* a, const char* b) {
-    /**
-     * Return the maximum unsigned long integer as a 
-     * non-sensical value to represent the function not
-     * having been implemented yet.
-     *
-     */
-    return (size_t) -1;
-}
+static size_t calculate_damerau_levenshtein_distance(const char* a, size_t a_length, const char* b, size_t b_length) {
+    edit_distance_workspace_t workspace = { NULL, 0 };
 
-static size_t calculate_hamming_distance(const char* a, const char* b) {
-    /**
-     * Return the maximum unsigned long integer as a 
-     * non-sensical value to represent the function not
-     * having been implemented yet.
-     *
-     */
-    return (size_t) -1;
-}
+    const size_t distance = damerau_levenshtein_distance(&workspace, a, a_length, b, b_length);
 
-static size_t calculate_damerau_levenshtein_distance(const char* a, const char* b) {
-    /**
-     * Return the maximum unsigned long integer as a 
-     * non-sensical value to represent the function not
-     * having been implemented yet.
-     *
-     */
-    return (size_t) -1;
+    free(workspace.buffer);
+
+    return distance;
 }
 
-static size_t calculate_jaro_distance(const char* a, const char* b) {
+/**
+ * Calculate the Jaro distance between the strings
+ * represented by a and b.
+ *
+ * The Jaro similarity is a fraction, which no edit distance
+ * can express directly, so it is scaled to the length of
+ * the longer string: the distance is the complement of the
+ * similarity times that length, rounded up, so that it is
+ * zero only for identical strings, and the length of the
+ * longer string for strings with no characters in common. The fraction itself is the JARO_SIMILARITY of
+ * calculate_string_similarity().
+ *
+ * @returns The scaled Jaro distance between a and b.
+ *
+ */
+static size_t calculate_jaro_distance(const char* a, size_t a_length, const char* b, size_t b_length) {
+    const double similarity = calculate_string_similarity_n(JARO_SIMILARITY, a, a_length, b, b_length);
+
+    const size_t longest = MAX(a_length, b_length);
+
     /**
-     * Return the maximum unsigned long integer as a 
-     * non-sensical value to represent the function not
-     * having been implemented yet.
+     * Round up, but not by a whole unit for the rounding
+     * error of a product that is an integer.
      *
      */
-    return (size_t) -1;
+    const double scaled = ((1.0 - similarity) * (double) longest) - 1e-9;
+
+    const size_t distance = (size_t) scaled;
+
+    return (scaled > (double) distance) ? distance + 1 : distance;
 }
 
 /**
@@ -198,7 +1189,7 @@ static size_t calculate_jaro_distance(const char* a, const char* b) {
  * @typedef edit_distance_function_t
  *
  */
-typedef size_t (*edit_distance_function_t)(const char*, const char*);
+typedef size_t (*edit_distance_function_t)(const char*, size_t, const char*, size_t);
 
 /**
  * Get Edit Distance Function
@@ -246,6 +1237,10 @@ static edit_distance_function_t get_edit_distance_function(edit_distance_type_t
             edit_distance_function = calculate_jaro_distance;
         } break;
 
+        case OPTIMAL_STRING_ALIGNMENT_DISTANCE: {
+            edit_distance_function = calculate_optimal_string_alignment_distance;
+        } break;
+
         default: {
             /**
              * The default action here will be to let the user know
@@ -264,6 +1259,27 @@ static edit_distance_function_t get_edit_distance_function(edit_distance_type_t
     return edit_distance_function;
 }
 
+/**
+ * Calculate the edit distance of two given buffers.
+ *
+ * This function is the length-delimited counterpart of
+ * calculate_edit_distance(). Neither buffer need be
+ * null-terminated.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The first buffer to compare.
+ * @param[in] a_length              The length of a.
+ * @param[in] b                     The second buffer to compare.
+ * @param[in] b_length              The length of b.
+ *
+ * @returns The edit distance between a and b, as calculated
+ * by the edit distance algorithm specified.
+ *
+ */
+size_t calculate_edit_distance_n(edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length) {
+    return get_edit_distance_function(edit_distance_type)(a, a_length, b, b_length);
+}
+
 /**
  * Calculate the edit distance of two given strings.
  *
@@ -281,5 +1297,472 @@ static edit_distance_function_t get_edit_distance_function(edit_distance_type_t
  *
  */
 size_t calculate_edit_distance(edit_distance_type_t edit_distance_type, const char* a, const char* b) {
-    return get_edit_distance_function(edit_distance_type)(a,b);
+    return calculate_edit_distance_n(edit_distance_type, a, string_length(a), b, string_length(b));
+}
+
+/**
+ * Calculate the edit distance of two buffers, up to a bound.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The first buffer to compare.
+ * @param[in] a_length              The length of a.
+ * @param[in] b                     The second buffer to compare.
+ * @param[in] b_length              The length of b.
+ * @param[in] max                   The largest distance of interest.
+ *
+ * @returns The edit distance between a and b, if it is at
+ * most max, or EDIT_DISTANCE_EXCEEDED otherwise.
+ *
+ */
+size_t calculate_edit_distance_bounded_n(edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length, size_t max) {
+    edit_distance_workspace_t workspace = { NULL, 0 };
+
+    const size_t distance = calculate_edit_distance_bounded_workspace_n(&workspace, edit_distance_type, a, a_length, b, b_length, max);
+
+    free(workspace.buffer);
+
+    return distance;
+}
+
+/**
+ * Calculate the edit distance of two strings, up to a bound.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The first string to compare.
+ * @param[in] b                     The second string to compare.
+ * @param[in] max                   The largest distance of interest.
+ *
+ * @returns The edit distance between a and b, if it is at
+ * most max, or EDIT_DISTANCE_EXCEEDED otherwise.
+ *
+ */
+size_t calculate_edit_distance_bounded(edit_distance_type_t edit_distance_type, const char* a, const char* b, size_t max) {
+    return calculate_edit_distance_bounded_n(edit_distance_type, a, string_length(a), b, string_length(b), max);
+}
+
+/**
+ * Create Edit Distance Workspace
+ *
+ * @param[in] capacity The number of bytes to reserve up front.
+ *
+ * @returns A new workspace, to be released with
+ * free_edit_distance_workspace().
+ *
+ */
+edit_distance_workspace_t* create_edit_distance_workspace(size_t capacity) {
+    edit_distance_workspace_t* workspace = malloc(sizeof (edit_distance_workspace_t));
+
+    if (workspace == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    workspace->buffer = NULL;
+    workspace->capacity = 0;
+
+    if (capacity > 0) {
+        reserve_edit_distance_workspace(workspace, capacity);
+    }
+
+    return workspace;
+}
+
+/**
+ * Calculate the edit distance of two buffers, using the
+ * given workspace for scratch memory.
+ *
+ * @param[in,out] workspace         The workspace to draw scratch memory from.
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The first buffer to compare.
+ * @param[in] a_length              The length of a.
+ * @param[in] b                     The second buffer to compare.
+ * @param[in] b_length              The length of b.
+ *
+ * @returns The edit distance between a and b, as calculated
+ * by the edit distance algorithm specified.
+ *
+ */
+size_t calculate_edit_distance_workspace_n(edit_distance_workspace_t* workspace, edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length) {
+    switch (edit_distance_type) {
+        case LEVENSHTEIN_DISTANCE: {
+            return levenshtein_distance(workspace, a, a_length, b, b_length);
+        }
+
+        case LONGEST_COMMON_SUBSEQUENCE: {
+            return longest_common_subsequence(workspace, a, a_length, b, b_length);
+        }
+
+        case DAMERAU_LEVENSHTEIN_DISTANCE: {
+            return damerau_levenshtein_distance(workspace, a, a_length, b, b_length);
+        }
+
+        case OPTIMAL_STRING_ALIGNMENT_DISTANCE: {
+            return optimal_string_alignment_distance(workspace, a, a_length, b, b_length);
+        }
+
+        default: {
+            return calculate_edit_distance_n(edit_distance_type, a, a_length, b, b_length);
+        }
+    }
+}
+
+/**
+ * Calculate the edit distance of two buffers, up to a bound,
+ * using the given workspace for scratch memory.
+ *
+ * @param[in,out] workspace         The workspace to draw scratch memory from.
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The first buffer to compare.
+ * @param[in] a_length              The length of a.
+ * @param[in] b                     The second buffer to compare.
+ * @param[in] b_length              The length of b.
+ * @param[in] max                   The largest distance of interest.
+ *
+ * @returns The edit distance between a and b, if it is at
+ * most max, or EDIT_DISTANCE_EXCEEDED otherwise.
+ *
+ */
+size_t calculate_edit_distance_bounded_workspace_n(edit_distance_workspace_t* workspace, edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length, size_t max) {
+    if (edit_distance_type == LEVENSHTEIN_DISTANCE) {
+        return bounded_levenshtein_distance(workspace, a, a_length, b, b_length, max);
+    }
+
+    /**
+     * The difference in length is a lower bound on every
+     * distance that charges one edit per unmatched character.
+     *
+     */
+    const int length_bounded = (edit_distance_type == HAMMING_DISTANCE)
+        || (edit_distance_type == DAMERAU_LEVENSHTEIN_DISTANCE)
+        || (edit_distance_type == OPTIMAL_STRING_ALIGNMENT_DISTANCE);
+
+    if (length_bounded && (MAX(a_length, b_length) - MIN(a_length, b_length) > max)) {
+        return EDIT_DISTANCE_EXCEEDED;
+    }
+
+    const size_t distance = calculate_edit_distance_workspace_n(workspace, edit_distance_type, a, a_length, b, b_length);
+
+    return (distance <= max) ? distance : EDIT_DISTANCE_EXCEEDED;
+}
+
+/**
+ * Free Edit Distance Workspace
+ *
+ * @param[in] workspace The workspace to release.
+ *
+ */
+void free_edit_distance_workspace(edit_distance_workspace_t* workspace) {
+    if (workspace == NULL) {
+        return;
+    }
+
+    free(workspace->buffer);
+    free(workspace);
+}
+
+/**
+ * Count Bit Differences (Generic)
+ *
+ * @param[in] a The first bit vector to compare.
+ * @param[in] b The second bit vector to compare.
+ * @param[in] count The number of words in both bit vectors.
+ *
+ * @returns The number of bits in which a and b differ.
+ *
+ */
+static size_t count_bit_differences_generic(const uint64_t* a, const uint64_t* b, size_t count) {
+    size_t differences = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        differences += (size_t) __builtin_popcountll(a[i] ^ b[i]);
+    }
+
+    return differences;
+}
+
+#ifdef XLIBS_HAMMING_DISTANCE_SIMD
+
+/**
+ * Count Bit Differences (POPCNT)
+ *
+ * This function counts the differing bits with the
+ * hardware population count instruction, spreading the
+ * sums over four accumulators so that the additions of
+ * consecutive words do not wait on one another.
+ *
+ * @see count_bit_differences_generic()
+ *
+ */
+__attribute__((target("popcnt")))
+static size_t count_bit_differences_popcnt(const uint64_t* a, const uint64_t* b, size_t count) {
+    size_t sums[4] = { 0, 0, 0, 0 };
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        sums[0] += (size_t) __builtin_popcountll(a[i] ^ b[i]);
+        sums[1] += (size_t) __builtin_popcountll(a[i + 1] ^ b[i + 1]);
+        sums[2] += (size_t) __builtin_popcountll(a[i + 2] ^ b[i + 2]);
+        sums[3] += (size_t) __builtin_popcountll(a[i + 3] ^ b[i + 3]);
+    }
+
+    for (; i < count; ++i) {
+        sums[0] += (size_t) __builtin_popcountll(a[i] ^ b[i]);
+    }
+
+    return sums[0] + sums[1] + sums[2] + sums[3];
+}
+
+/**
+ * Count Bit Differences (AVX-512 VPOPCNTDQ)
+ *
+ * This function counts the differing bits of eight words
+ * at once with the vector population count instruction,
+ * the last partial vector being read with a masked load.
+ *
+ * @see count_bit_differences_generic()
+ *
+ */
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static size_t count_bit_differences_avx512vpopcntdq(const uint64_t* a, const uint64_t* b, size_t count) {
+    __m512i sums = _mm512_setzero_si512();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        const __m512i x = _mm512_loadu_si512((const void*) (a + i));
+        const __m512i y = _mm512_loadu_si512((const void*) (b + i));
+
+        sums = _mm512_add_epi64(sums, _mm512_popcnt_epi64(_mm512_xor_si512(x, y)));
+    }
+
+    if (i < count) {
+        const __mmask8 mask = (__mmask8) ((1U << (count - i)) - 1);
+
+        const __m512i x = _mm512_maskz_loadu_epi64(mask, a + i);
+        const __m512i y = _mm512_maskz_loadu_epi64(mask, b + i);
+
+        sums = _mm512_add_epi64(sums, _mm512_popcnt_epi64(_mm512_xor_si512(x, y)));
+    }
+
+    return (size_t) _mm512_reduce_add_epi64(sums);
+}
+
+#endif /** XLIBS_HAMMING_DISTANCE_SIMD */
+
+/**
+ * Calculate the Hamming distance between two bit vectors.
+ *
+ * @param[in] a The first bit vector to compare.
+ * @param[in] b The second bit vector to compare.
+ * @param[in] count The number of 64-bit words in both bit vectors.
+ *
+ * @returns The number of bits in which a and b differ.
+ *
+ */
+size_t calculate_packed_hamming_distance(const uint64_t* a, const uint64_t* b, size_t count) {
+#ifdef XLIBS_HAMMING_DISTANCE_SIMD
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+        return count_bit_differences_avx512vpopcntdq(a, b, count);
+    }
+
+    if (__builtin_cpu_supports("popcnt")) {
+        return count_bit_differences_popcnt(a, b, count);
+    }
+#endif
+
+    return count_bit_differences_generic(a, b, count);
+}
+
+/**
+ * Token Slot
+ *
+ * A slot of the open-addressing table mapping each distinct
+ * token of the pattern to a dense ID, starting from one, so
+ * that an ID of zero marks an empty slot.
+ *
+ */
+typedef struct {
+    uint32_t token;
+    uint32_t id;
+} token_slot_t;
+
+/**
+ * Get Token Slot
+ *
+ * @param[in] slots The table of tokens.
+ * @param[in] bits The base-2 logarithm of the size of the table.
+ * @param[in] token The token to look up.
+ *
+ * @returns The index of the slot holding the token, or of
+ * the empty slot where it would be inserted.
+ *
+ */
+static size_t get_token_slot(const token_slot_t* slots, unsigned int bits, uint32_t token) {
+    const size_t mask = ((size_t) 1 << bits) - 1;
+
+    /** Fibonacci hashing spreads consecutive tokens apart. */
+    size_t slot = (size_t) (((uint64_t) token * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - bits));
+
+    while ((slots[slot].id != 0) && (slots[slot].token != token)) {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * Calculate the length of the longest common subsequence
+ * of two arrays of 32-bit tokens.
+ *
+ * This function runs the same bit-parallel algorithm as the
+ * LONGEST_COMMON_SUBSEQUENCE metric, over token IDs, such
+ * as the interned lines of two files being diffed. With an
+ * alphabet too large for a table of match masks per symbol,
+ * and too many distinct tokens for a mask of the whole
+ * pattern per token, the tokens are first renamed to dense
+ * IDs, and the bit vector is advanced one 64-bit word at a
+ * time over the whole text, rather than one character at a
+ * time over every word. Only the masks of the 64 tokens of
+ * the pattern covered by the current word are then needed,
+ * in an array indexed by ID, along with the carry out of
+ * the previous word for each character of the text.
+ *
+ * Tokens of the longer array missing from the shorter one
+ * have empty masks, which leave the whole bit vector
+ * unchanged, since no carry enters the lowest word, so
+ * they are dropped before scanning.
+ *
+ * @param[in] a The first array of tokens.
+ * @param[in] a_length The number of tokens in a.
+ * @param[in] b The second array of tokens.
+ * @param[in] b_length The number of tokens in b.
+ *
+ * @returns The length of the longest common subsequence of
+ * a and b.
+ *
+ */
+size_t calculate_token_longest_common_subsequence(const uint32_t* a, size_t a_length, const uint32_t* b, size_t b_length) {
+    size_t prefix = 0;
+
+    while ((prefix < a_length) && (prefix < b_length) && (a[prefix] == b[prefix])) {
+        ++prefix;
+    }
+
+    a += prefix;
+    b += prefix;
+    a_length -= prefix;
+    b_length -= prefix;
+
+    size_t suffix = 0;
+
+    while ((suffix < a_length) && (suffix < b_length) && (a[a_length - suffix - 1] == b[b_length - suffix - 1])) {
+        ++suffix;
+    }
+
+    a_length -= suffix;
+    b_length -= suffix;
+
+    if (a_length > b_length) {
+        const uint32_t* swap = a;
+        a = b;
+        b = swap;
+
+        const size_t swap_length = a_length;
+        a_length = b_length;
+        b_length = swap_length;
+    }
+
+    if (a_length == 0) {
+        return prefix + suffix;
+    }
+
+    unsigned int bits = 1;
+
+    while (((size_t) 1 << bits) < 2 * a_length) {
+        ++bits;
+    }
+
+    token_slot_t* slots = calloc((size_t) 1 << bits, sizeof (token_slot_t));
+    uint32_t* a_ids = malloc(sizeof (uint32_t) * a_length);
+    uint32_t* b_ids = malloc(sizeof (uint32_t) * b_length);
+
+    if ((slots == NULL) || (a_ids == NULL) || (b_ids == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    uint32_t ids = 0;
+
+    for (size_t i = 0; i < a_length; ++i) {
+        const size_t slot = get_token_slot(slots, bits, a[i]);
+
+        if (slots[slot].id == 0) {
+            slots[slot].token = a[i];
+            slots[slot].id = ++ids;
+        }
+
+        a_ids[i] = slots[slot].id;
+    }
+
+    size_t n = 0;
+
+    for (size_t j = 0; j < b_length; ++j) {
+        const uint32_t id = slots[get_token_slot(slots, bits, b[j])].id;
+
+        if (id != 0) {
+            b_ids[n++] = id;
+        }
+    }
+
+    free(slots);
+
+    /** The masks of the current word, indexed by ID, and the carries into it. */
+    uint64_t* masks = calloc((size_t) ids + 1, sizeof (uint64_t));
+    unsigned char* carries = calloc(MAX(n, (size_t) 1), sizeof (unsigned char));
+
+    if ((masks == NULL) || (carries == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t length = prefix + suffix;
+
+    for (size_t begin = 0; begin < a_length; begin += 64) {
+        const size_t end = MIN(begin + 64, a_length);
+
+        for (size_t i = begin; i < end; ++i) {
+            masks[a_ids[i]] |= (uint64_t) 1 << (i - begin);
+        }
+
+        uint64_t v = ~(uint64_t) 0;
+
+        for (size_t j = 0; j < n; ++j) {
+            const uint64_t mask = masks[b_ids[j]];
+            const uint64_t u = v & mask;
+
+            uint64_t sum;
+
+            const unsigned char first = (unsigned char) __builtin_add_overflow(v, u, &sum);
+            const unsigned char second = (unsigned char) __builtin_add_overflow(sum, (uint64_t) carries[j], &sum);
+
+            carries[j] = first | second;
+            v = sum | (v & ~mask);
+        }
+
+        const uint64_t valid = (end - begin == 64) ? ~(uint64_t) 0 : (((uint64_t) 1 << (end - begin)) - 1);
+
+        length += (size_t) __builtin_popcountll(~v & valid);
+
+        for (size_t i = begin; i < end; ++i) {
+            masks[a_ids[i]] = 0;
+        }
+    }
+
+    free(a_ids);
+    free(b_ids);
+    free(masks);
+    free(carries);
+
+    return length;
 }
@@ -0,0 +1,927 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ *
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xstrings.h"
+
+#ifndef MAX
+#define MAX(a,b) ((a < b) ? (b) : (a))
+#endif
+
+#ifndef MIN
+#define MIN(a,b) ((a > b) ? (b) : (a))
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+
+/**
+ * This macro is defined when the vectorized implementations
+ * of the inter-sequence Levenshtein distance are available.
+ *
+ * @def XLIBS_LEVENSHTEIN_LANES
+ *
+ */
+#define XLIBS_LEVENSHTEIN_LANES
+#endif
+
+/**
+ * Edit Distance Batch Chunk
+ *
+ * The candidates of a batch are handed out to the worker
+ * threads in chunks of this many, so that threads that
+ * happen to draw shorter candidates keep busy by taking
+ * more chunks.
+ *
+ * @def EDIT_DISTANCE_BATCH_CHUNK
+ *
+ */
+#ifndef EDIT_DISTANCE_BATCH_CHUNK
+#define EDIT_DISTANCE_BATCH_CHUNK 256
+#endif
+
+/**
+ * Edit Distance Batch Minimum Per Thread
+ *
+ * A batch only starts another thread for every this many
+ * candidates, since smaller batches finish before the
+ * thread would have started.
+ *
+ * @def EDIT_DISTANCE_BATCH_MINIMUM_PER_THREAD
+ *
+ */
+#ifndef EDIT_DISTANCE_BATCH_MINIMUM_PER_THREAD
+#define EDIT_DISTANCE_BATCH_MINIMUM_PER_THREAD 4096
+#endif
+
+/**
+ * Edit Distance Batch Maximum Threads
+ *
+ * @def EDIT_DISTANCE_BATCH_MAXIMUM_THREADS
+ *
+ */
+#ifndef EDIT_DISTANCE_BATCH_MAXIMUM_THREADS
+#define EDIT_DISTANCE_BATCH_MAXIMUM_THREADS 64
+#endif
+
+/**
+ * Levenshtein Lanes Function
+ *
+ * A lanes function computes the Levenshtein distances of a
+ * string of at most 64 characters, given by its match masks,
+ * to as many candidates at once as its vector registers
+ * have 64-bit lanes.
+ *
+ * @typedef levenshtein_lanes_function_t
+ *
+ */
+typedef void (*levenshtein_lanes_function_t)(const uint64_t* peq, size_t m, const char* const* b, const size_t* n, size_t* distances);
+
+#ifdef XLIBS_LEVENSHTEIN_LANES
+
+/**
+ * Levenshtein Distance Lanes (AVX2)
+ *
+ * This function runs the single word bit-parallel algorithm
+ * of run_levenshtein_single_word() on four candidates at
+ * once, one per 64-bit lane. Since the query is the same for
+ * every lane, only the match masks of each lane's current
+ * character differ between them. A lane whose candidate is
+ * shorter than the others keeps its state, and thereby its
+ * score, unchanged once its candidate has been consumed.
+ *
+ * @param[in] peq The match masks of the query, in a single block.
+ * @param[in] m The length of the query, between 1 and 64.
+ * @param[in] b The four candidates.
+ * @param[in] n The lengths of the candidates.
+ * @param[out] distances The distance of each candidate to the query.
+ *
+ * @cite hyyro_bit-parallel_2001
+ *
+ */
+__attribute__((target("avx2")))
+static void levenshtein_distance_lanes_avx2(const uint64_t* peq, size_t m, const char* const* b, const size_t* n, size_t* distances) {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i last = _mm256_set1_epi64x((long long) ((uint64_t) 1 << (m - 1)));
+    const __m128i shift = _mm_cvtsi64_si128((long long) (m - 1));
+    const __m256i lengths = _mm256_loadu_si256((const __m256i*) n);
+
+    const size_t longest = MAX(MAX(n[0], n[1]), MAX(n[2], n[3]));
+
+    __m256i vp = ones;
+    __m256i vn = _mm256_setzero_si256();
+    __m256i score = _mm256_set1_epi64x((long long) m);
+
+    for (size_t j = 0; j < longest; ++j) {
+        uint64_t eqs[4];
+
+        for (size_t lane = 0; lane < 4; ++lane) {
+            eqs[lane] = (j < n[lane]) ? peq[(unsigned char) b[lane][j]] : 0;
+        }
+
+        const __m256i eq = _mm256_loadu_si256((const __m256i*) eqs);
+        const __m256i active = _mm256_cmpgt_epi64(lengths, _mm256_set1_epi64x((long long) j));
+
+        const __m256i xv = _mm256_or_si256(eq, vn);
+        const __m256i xh = _mm256_or_si256(_mm256_xor_si256(_mm256_add_epi64(_mm256_and_si256(eq, vp), vp), vp), eq);
+
+        __m256i hp = _mm256_or_si256(vn, _mm256_andnot_si256(_mm256_or_si256(xh, vp), ones));
+        __m256i hn = _mm256_and_si256(vp, xh);
+
+        const __m256i increase = _mm256_srl_epi64(_mm256_and_si256(hp, last), shift);
+        const __m256i decrease = _mm256_srl_epi64(_mm256_and_si256(hn, last), shift);
+
+        score = _mm256_add_epi64(score, _mm256_and_si256(_mm256_sub_epi64(increase, decrease), active));
+
+        hp = _mm256_or_si256(_mm256_slli_epi64(hp, 1), one);
+        hn = _mm256_slli_epi64(hn, 1);
+
+        vp = _mm256_blendv_epi8(vp, _mm256_or_si256(hn, _mm256_andnot_si256(_mm256_or_si256(xv, hp), ones)), active);
+        vn = _mm256_blendv_epi8(vn, _mm256_and_si256(hp, xv), active);
+    }
+
+    _mm256_storeu_si256((__m256i*) distances, score);
+}
+
+/**
+ * Levenshtein Distance Lanes (AVX-512F)
+ *
+ * @see levenshtein_distance_lanes_avx2()
+ *
+ */
+__attribute__((target("avx512f")))
+static void levenshtein_distance_lanes_avx512f(const uint64_t* peq, size_t m, const char* const* b, const size_t* n, size_t* distances) {
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i last = _mm512_set1_epi64((long long) ((uint64_t) 1 << (m - 1)));
+    const __m128i shift = _mm_cvtsi64_si128((long long) (m - 1));
+
+    size_t longest = 0;
+
+    for (size_t lane = 0; lane < 8; ++lane) {
+        longest = MAX(longest, n[lane]);
+    }
+
+    __m512i vp = _mm512_set1_epi64(-1);
+    __m512i vn = _mm512_setzero_si512();
+    __m512i score = _mm512_set1_epi64((long long) m);
+
+    for (size_t j = 0; j < longest; ++j) {
+        uint64_t eqs[8];
+        __mmask8 active = 0;
+
+        for (size_t lane = 0; lane < 8; ++lane) {
+            if (j < n[lane]) {
+                eqs[lane] = peq[(unsigned char) b[lane][j]];
+                active |= (__mmask8) (1U << lane);
+            } else {
+                eqs[lane] = 0;
+            }
+        }
+
+        const __m512i eq = _mm512_loadu_si512((const void*) eqs);
+
+        const __m512i xv = _mm512_or_si512(eq, vn);
+        const __m512i xh = _mm512_or_si512(_mm512_xor_si512(_mm512_add_epi64(_mm512_and_si512(eq, vp), vp), vp), eq);
+
+        /** The truth table 0xF1 computes A | ~(B | C). */
+        __m512i hp = _mm512_ternarylogic_epi64(vn, xh, vp, 0xF1);
+        __m512i hn = _mm512_and_si512(vp, xh);
+
+        const __m512i increase = _mm512_srl_epi64(_mm512_and_si512(hp, last), shift);
+        const __m512i decrease = _mm512_srl_epi64(_mm512_and_si512(hn, last), shift);
+
+        score = _mm512_mask_add_epi64(score, active, score, _mm512_sub_epi64(increase, decrease));
+
+        hp = _mm512_or_si512(_mm512_slli_epi64(hp, 1), one);
+        hn = _mm512_slli_epi64(hn, 1);
+
+        vp = _mm512_mask_mov_epi64(vp, active, _mm512_ternarylogic_epi64(hn, xv, hp, 0xF1));
+        vn = _mm512_mask_mov_epi64(vn, active, _mm512_and_si512(hp, xv));
+    }
+
+    _mm512_storeu_si512((void*) distances, score);
+}
+
+#endif /** XLIBS_LEVENSHTEIN_LANES */
+
+/**
+ * Get Levenshtein Lanes Function
+ *
+ * @param[out] lanes The number of candidates the function takes.
+ *
+ * @returns The widest lanes function supported by the host,
+ * or NULL if none of them are.
+ *
+ */
+static levenshtein_lanes_function_t get_levenshtein_lanes_function(size_t* lanes) {
+#ifdef XLIBS_LEVENSHTEIN_LANES
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        *lanes = 8;
+        return levenshtein_distance_lanes_avx512f;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        *lanes = 4;
+        return levenshtein_distance_lanes_avx2;
+    }
+#endif
+
+    *lanes = 1;
+    return NULL;
+}
+
+/**
+ * Edit Distance Batch
+ *
+ * The state shared by the worker threads of a batch: the
+ * query and its match masks, the candidates, the index of
+ * the next chunk to be handed out, and where the results
+ * go. Exactly one of distances and nearest_indices is set.
+ *
+ */
+typedef struct {
+    edit_distance_type_t type;
+    const char* query;
+    size_t query_length;
+    const char* const* candidates;
+    const size_t* candidate_lengths;
+    size_t count;
+    uint64_t* peq;
+    size_t blocks;
+    levenshtein_lanes_function_t lanes_function;
+    size_t lanes;
+    size_t next;
+    size_t* distances;
+    size_t k;
+    size_t* nearest_indices;
+    size_t* nearest_distances;
+} edit_distance_batch_t;
+
+/**
+ * Edit Distance Batch Worker
+ *
+ * The state private to each worker thread: its scratch
+ * memory, and, when looking for the nearest candidates, a
+ * max-heap of the k nearest of the candidates it has seen.
+ * Both are kept from one batch to the next.
+ *
+ */
+typedef struct {
+    edit_distance_batch_t* batch;
+    edit_distance_workspace_t* workspace;
+    size_t* heap_distances;
+    size_t* heap_indices;
+    size_t heap_size;
+    size_t heap_capacity;
+    size_t generation;
+    pthread_t thread;
+} edit_distance_batch_worker_t;
+
+/**
+ * Edit Distance Thread Pool
+ *
+ * The worker threads shared by every batch. They are
+ * started by the first batch large enough to need them and
+ * then wait for the next one, so that a batch only wakes
+ * threads up instead of creating them. The calling thread
+ * takes the place of the first worker, so that of the
+ * workers array only the others are ever threads.
+ *
+ * The pool runs one batch at a time, held by the batch
+ * mutex. Each batch bumps the generation, and the first
+ * participants workers, the caller included, take part in
+ * it; the caller waits until the active count drops back to
+ * zero. Each worker remembers the last generation it saw,
+ * so that a thread that is slow to start still takes part
+ * in the batch that started it.
+ *
+ */
+typedef struct {
+    pthread_mutex_t batch_mutex;
+    pthread_mutex_t mutex;
+    pthread_cond_t batch_ready;
+    pthread_cond_t batch_done;
+    size_t generation;
+    size_t participants;
+    size_t active;
+    size_t size;
+    edit_distance_batch_worker_t workers[EDIT_DISTANCE_BATCH_MAXIMUM_THREADS];
+} edit_distance_thread_pool_t;
+
+/**
+ * The thread pool of the edit distance batches.
+ *
+ */
+static edit_distance_thread_pool_t thread_pool = {
+    .batch_mutex = PTHREAD_MUTEX_INITIALIZER,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .batch_ready = PTHREAD_COND_INITIALIZER,
+    .batch_done = PTHREAD_COND_INITIALIZER,
+    .size = 1
+};
+
+/**
+ * Candidate Precedes
+ *
+ * @returns Nonzero if the candidate at index i and distance
+ * d ranks before the one at index j and distance e.
+ *
+ */
+static inline int candidate_precedes(size_t d, size_t i, size_t e, size_t j) {
+    return (d < e) || ((d == e) && (i < j));
+}
+
+/**
+ * Sift Down Nearest Candidate
+ *
+ * This function places the candidate at the given position
+ * of the max-heap, moving the larger of its children up
+ * until the heap is ordered again.
+ *
+ * @param[in,out] distances The distances of the heap.
+ * @param[in,out] indices The indices of the heap.
+ * @param[in] size The number of candidates in the heap.
+ * @param[in] distance The distance of the candidate to place.
+ * @param[in] index The index of the candidate to place.
+ *
+ */
+static void sift_down_nearest_candidate(size_t* distances, size_t* indices, size_t size, size_t distance, size_t index) {
+    size_t position = 0;
+
+    for (;;) {
+        size_t child = (2 * position) + 1;
+
+        if (child >= size) {
+            break;
+        }
+
+        if ((child + 1 < size) && candidate_precedes(distances[child], indices[child], distances[child + 1], indices[child + 1])) {
+            ++child;
+        }
+
+        if (!candidate_precedes(distance, index, distances[child], indices[child])) {
+            break;
+        }
+
+        distances[position] = distances[child];
+        indices[position] = indices[child];
+        position = child;
+    }
+
+    distances[position] = distance;
+    indices[position] = index;
+}
+
+/**
+ * Push Nearest Candidate
+ *
+ * This function adds a candidate to the worker's heap of
+ * nearest candidates, evicting the farthest one if the heap
+ * is full and the new candidate ranks before it.
+ *
+ * @param[in,out] worker The worker that computed the distance.
+ * @param[in] distance The distance of the candidate to the query.
+ * @param[in] index The index of the candidate.
+ *
+ */
+static void push_nearest_candidate(edit_distance_batch_worker_t* worker, size_t distance, size_t index) {
+    size_t* distances = worker->heap_distances;
+    size_t* indices = worker->heap_indices;
+
+    if (worker->heap_size < worker->batch->k) {
+        size_t position = worker->heap_size++;
+
+        while (position > 0) {
+            const size_t parent = (position - 1) / 2;
+
+            if (!candidate_precedes(distances[parent], indices[parent], distance, index)) {
+                break;
+            }
+
+            distances[position] = distances[parent];
+            indices[position] = indices[parent];
+            position = parent;
+        }
+
+        distances[position] = distance;
+        indices[position] = index;
+        return;
+    }
+
+    if (candidate_precedes(distance, index, distances[0], indices[0])) {
+        sift_down_nearest_candidate(distances, indices, worker->heap_size, distance, index);
+    }
+}
+
+/**
+ * Get Candidate Length
+ *
+ */
+static inline size_t get_candidate_length(const edit_distance_batch_t* batch, size_t index) {
+    if (batch->candidate_lengths != NULL) {
+        return batch->candidate_lengths[index];
+    }
+
+    return string_length(batch->candidates[index]);
+}
+
+/**
+ * Calculate Candidate Edit Distance
+ *
+ * This function computes the distance of a single candidate
+ * to the query, reusing the query's match masks for the
+ * Levenshtein distance.
+ *
+ * @param[in,out] worker The worker computing the distance.
+ * @param[in] index The index of the candidate.
+ *
+ * @returns The distance of the candidate to the query.
+ *
+ */
+static size_t calculate_candidate_edit_distance(edit_distance_batch_worker_t* worker, size_t index) {
+    const edit_distance_batch_t* batch = worker->batch;
+
+    const char* b = batch->candidates[index];
+    const size_t n = get_candidate_length(batch, index);
+
+    if (batch->type != LEVENSHTEIN_DISTANCE) {
+        return calculate_edit_distance_workspace_n(worker->workspace, batch->type, batch->query, batch->query_length, b, n);
+    }
+
+    if (batch->query_length == 0) {
+        return n;
+    }
+
+    if (batch->blocks == 1) {
+        return run_levenshtein_single_word(batch->peq, batch->query_length, b, n);
+    }
+
+    uint64_t* vectors = reserve_edit_distance_workspace(worker->workspace, sizeof (uint64_t) * 2 * batch->blocks);
+
+    return run_levenshtein_blocked(batch->peq, batch->blocks, vectors, vectors + batch->blocks, batch->query_length, b, n);
+}
+
+/**
+ * Calculate Chunk Edit Distances
+ *
+ * @param[in,out] worker The worker computing the distances.
+ * @param[in] begin The index of the first candidate of the chunk.
+ * @param[in] end The index one past the last candidate of the chunk.
+ * @param[out] distances The distances of the candidates of the chunk.
+ *
+ */
+static void calculate_chunk_edit_distances(edit_distance_batch_worker_t* worker, size_t begin, size_t end, size_t* distances) {
+    const edit_distance_batch_t* batch = worker->batch;
+
+    size_t i = begin;
+
+    if (batch->lanes_function != NULL) {
+        const char* b[8];
+        size_t n[8];
+
+        for (; i + batch->lanes <= end; i += batch->lanes) {
+            for (size_t lane = 0; lane < batch->lanes; ++lane) {
+                b[lane] = batch->candidates[i + lane];
+                n[lane] = get_candidate_length(batch, i + lane);
+            }
+
+            batch->lanes_function(batch->peq, batch->query_length, b, n, distances + (i - begin));
+        }
+    }
+
+    for (; i < end; ++i) {
+        distances[i - begin] = calculate_candidate_edit_distance(worker, i);
+    }
+}
+
+/**
+ * Run Edit Distance Batch Worker
+ *
+ * This function has a worker repeatedly claim the next
+ * chunk of candidates of its batch until none are left.
+ *
+ * @param[in,out] worker The worker to run.
+ *
+ */
+static void run_edit_distance_batch_worker(edit_distance_batch_worker_t* worker) {
+    edit_distance_batch_t* batch = worker->batch;
+
+    size_t distances[EDIT_DISTANCE_BATCH_CHUNK];
+
+    for (;;) {
+        const size_t begin = __atomic_fetch_add(&batch->next, EDIT_DISTANCE_BATCH_CHUNK, __ATOMIC_RELAXED);
+
+        if (begin >= batch->count) {
+            break;
+        }
+
+        const size_t end = MIN(begin + EDIT_DISTANCE_BATCH_CHUNK, batch->count);
+
+        if (batch->distances != NULL) {
+            calculate_chunk_edit_distances(worker, begin, end, batch->distances + begin);
+            continue;
+        }
+
+        calculate_chunk_edit_distances(worker, begin, end, distances);
+
+        for (size_t i = begin; i < end; ++i) {
+            push_nearest_candidate(worker, distances[i - begin], i);
+        }
+    }
+}
+
+/**
+ * Run Edit Distance Pool Thread
+ *
+ * This is the body of every thread of the pool. The thread
+ * sleeps until a batch is posted, works on it if it is
+ * among the batch's participants, and goes back to sleep.
+ * The threads are never joined; they live as long as the
+ * process does.
+ *
+ * @param[in] argument The worker, as an edit_distance_batch_worker_t.
+ *
+ * @returns Never; the threads run until the process exits.
+ *
+ */
+static void* run_edit_distance_pool_thread(void* argument) {
+    edit_distance_batch_worker_t* worker = argument;
+
+    const size_t index = (size_t) (worker - thread_pool.workers);
+
+    pthread_mutex_lock(&thread_pool.mutex);
+
+    for (;;) {
+        while (thread_pool.generation == worker->generation) {
+            pthread_cond_wait(&thread_pool.batch_ready, &thread_pool.mutex);
+        }
+
+        worker->generation = thread_pool.generation;
+
+        if (index >= thread_pool.participants) {
+            continue;
+        }
+
+        pthread_mutex_unlock(&thread_pool.mutex);
+
+        run_edit_distance_batch_worker(worker);
+
+        pthread_mutex_lock(&thread_pool.mutex);
+
+        if (--thread_pool.active == 0) {
+            pthread_cond_signal(&thread_pool.batch_done);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Count Edit Distance Batch Threads
+ *
+ * @param[in] count The number of candidates in the batch.
+ *
+ * @returns The number of threads to spread the batch over.
+ *
+ */
+static size_t count_edit_distance_batch_threads(size_t count) {
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    size_t threads = (processors > 0) ? (size_t) processors : 1;
+
+    threads = MIN(threads, (size_t) EDIT_DISTANCE_BATCH_MAXIMUM_THREADS);
+    threads = MIN(threads, (count + EDIT_DISTANCE_BATCH_MINIMUM_PER_THREAD - 1) / EDIT_DISTANCE_BATCH_MINIMUM_PER_THREAD);
+
+    return MAX(threads, (size_t) 1);
+}
+
+/**
+ * Initialize Edit Distance Batch
+ *
+ * This function measures and preprocesses the query once
+ * for the whole batch.
+ *
+ */
+static void initialize_edit_distance_batch(edit_distance_batch_t* batch, edit_distance_type_t edit_distance_type, const char* query, size_t query_length, const char* const* candidates, const size_t* candidate_lengths, size_t count) {
+    memset(batch, 0, sizeof (edit_distance_batch_t));
+
+    batch->type = edit_distance_type;
+    batch->query = query;
+    batch->query_length = query_length;
+    batch->candidates = candidates;
+    batch->candidate_lengths = candidate_lengths;
+    batch->count = count;
+    batch->lanes = 1;
+
+    if ((edit_distance_type != LEVENSHTEIN_DISTANCE) || (query_length == 0)) {
+        return;
+    }
+
+    batch->blocks = (query_length + 63) / 64;
+    batch->peq = malloc(sizeof (uint64_t) * 256 * batch->blocks);
+
+    if (batch->peq == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    build_levenshtein_match_masks(batch->peq, batch->blocks, query, query_length);
+
+    if (batch->blocks == 1) {
+        batch->lanes_function = get_levenshtein_lanes_function(&batch->lanes);
+    }
+}
+
+/**
+ * Prepare Edit Distance Batch Worker
+ *
+ * This function assigns a worker to a batch, creating its
+ * scratch memory the first time and growing its heap to
+ * hold the k nearest candidates of the batch.
+ *
+ * @param[in,out] worker The worker to prepare.
+ * @param[in] batch The batch the worker is to take part in.
+ *
+ */
+static void prepare_edit_distance_batch_worker(edit_distance_batch_worker_t* worker, edit_distance_batch_t* batch) {
+    worker->batch = batch;
+    worker->heap_size = 0;
+
+    if (worker->workspace == NULL) {
+        worker->workspace = create_edit_distance_workspace(0);
+    }
+
+    if (batch->k > worker->heap_capacity) {
+        worker->heap_distances = realloc(worker->heap_distances, sizeof (size_t) * batch->k);
+        worker->heap_indices = realloc(worker->heap_indices, sizeof (size_t) * batch->k);
+
+        if ((worker->heap_distances == NULL) || (worker->heap_indices == NULL)) {
+            fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+            exit(EXIT_FAILURE);
+        }
+
+        worker->heap_capacity = batch->k;
+    }
+}
+
+/**
+ * Collect Nearest Candidates
+ *
+ * This function merges the heaps of the other workers into
+ * that of the first, which is then emptied, farthest
+ * candidate first, into the output arrays of the batch.
+ *
+ * @param[in,out] batch The batch whose workers have finished.
+ * @param[in,out] workers The workers that took part in the batch.
+ * @param[in] count The number of workers.
+ *
+ */
+static void collect_nearest_candidates(edit_distance_batch_t* batch, edit_distance_batch_worker_t* workers, size_t count) {
+    for (size_t i = 1; i < count; ++i) {
+        for (size_t j = 0; j < workers[i].heap_size; ++j) {
+            push_nearest_candidate(&workers[0], workers[i].heap_distances[j], workers[i].heap_indices[j]);
+        }
+    }
+
+    size_t* distances = workers[0].heap_distances;
+    size_t* indices = workers[0].heap_indices;
+
+    for (size_t size = workers[0].heap_size; size > 0; --size) {
+        batch->nearest_indices[size - 1] = indices[0];
+
+        if (batch->nearest_distances != NULL) {
+            batch->nearest_distances[size - 1] = distances[0];
+        }
+
+        sift_down_nearest_candidate(distances, indices, size - 1, distances[size - 1], indices[size - 1]);
+    }
+}
+
+/**
+ * Run Edit Distance Batch Alone
+ *
+ * This function runs a batch on the calling thread only,
+ * with a worker of its own.
+ *
+ * @param[in,out] batch The batch to run.
+ *
+ */
+static void run_edit_distance_batch_alone(edit_distance_batch_t* batch) {
+    edit_distance_batch_worker_t worker = { 0 };
+
+    prepare_edit_distance_batch_worker(&worker, batch);
+
+    run_edit_distance_batch_worker(&worker);
+
+    if (batch->k > 0) {
+        collect_nearest_candidates(batch, &worker, 1);
+    }
+
+    free_edit_distance_workspace(worker.workspace);
+    free(worker.heap_distances);
+    free(worker.heap_indices);
+}
+
+/**
+ * Run Edit Distance Batch
+ *
+ * This function spreads the batch over the thread pool,
+ * the calling thread being the first of its workers, and
+ * waits for the pool to finish with it. The pool is grown
+ * to as many threads as the batch calls for the first time
+ * they are needed.
+ *
+ * A batch too small to be worth more than one thread runs
+ * on the calling thread alone, as does one that arrives
+ * while the pool is busy with the batch of another thread.
+ * If a thread cannot be started, the workers that did start
+ * simply take up its share of the chunks.
+ *
+ * @param[in,out] batch The batch to run.
+ *
+ */
+static void run_edit_distance_batch(edit_distance_batch_t* batch) {
+    const size_t threads = count_edit_distance_batch_threads(batch->count);
+
+    if ((threads == 1) || (pthread_mutex_trylock(&thread_pool.batch_mutex) != 0)) {
+        run_edit_distance_batch_alone(batch);
+        return;
+    }
+
+    edit_distance_batch_worker_t* workers = thread_pool.workers;
+
+    while (thread_pool.size < threads) {
+        edit_distance_batch_worker_t* worker = &workers[thread_pool.size];
+
+        /**
+         * The thread must not miss the batch about to be posted,
+         * however late it gets to wait for it.
+         *
+         */
+        worker->generation = thread_pool.generation;
+
+        if (pthread_create(&worker->thread, NULL, run_edit_distance_pool_thread, worker) != 0) {
+            break;
+        }
+
+        ++thread_pool.size;
+    }
+
+    const size_t participants = MIN(threads, thread_pool.size);
+
+    for (size_t i = 0; i < participants; ++i) {
+        prepare_edit_distance_batch_worker(&workers[i], batch);
+    }
+
+    pthread_mutex_lock(&thread_pool.mutex);
+
+    thread_pool.participants = participants;
+    thread_pool.active = participants - 1;
+    ++thread_pool.generation;
+
+    pthread_cond_broadcast(&thread_pool.batch_ready);
+    pthread_mutex_unlock(&thread_pool.mutex);
+
+    run_edit_distance_batch_worker(&workers[0]);
+
+    pthread_mutex_lock(&thread_pool.mutex);
+
+    while (thread_pool.active > 0) {
+        pthread_cond_wait(&thread_pool.batch_done, &thread_pool.mutex);
+    }
+
+    pthread_mutex_unlock(&thread_pool.mutex);
+
+    if (batch->k > 0) {
+        collect_nearest_candidates(batch, workers, participants);
+    }
+
+    pthread_mutex_unlock(&thread_pool.batch_mutex);
+}
+
+/**
+ * Calculate the edit distance of one buffer to many.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] query                 The buffer to compare the candidates to.
+ * @param[in] query_length          The length of the query.
+ * @param[in] candidates            The buffers to compare the query to.
+ * @param[in] candidate_lengths     Their lengths, or NULL if they are strings.
+ * @param[in] count                 The number of candidates.
+ * @param[out] distances            The distance of each candidate to the query.
+ *
+ */
+void calculate_edit_distance_batch_n(edit_distance_type_t edit_distance_type, const char* query, size_t query_length, const char* const* candidates, const size_t* candidate_lengths, size_t count, size_t* distances) {
+    edit_distance_batch_t batch;
+
+    initialize_edit_distance_batch(&batch, edit_distance_type, query, query_length, candidates, candidate_lengths, count);
+
+    batch.distances = distances;
+
+    run_edit_distance_batch(&batch);
+
+    free(batch.peq);
+}
+
+/**
+ * Calculate the edit distance of one string to many.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] query                 The string to compare the candidates to.
+ * @param[in] candidates            The strings to compare the query to.
+ * @param[in] count                 The number of candidates.
+ * @param[out] distances            The distance of each candidate to the query.
+ *
+ */
+void calculate_edit_distance_batch(edit_distance_type_t edit_distance_type, const char* query, const char* const* candidates, size_t count, size_t* distances) {
+    calculate_edit_distance_batch_n(edit_distance_type, query, string_length(query), candidates, NULL, count, distances);
+}
+
+/**
+ * Find the candidates nearest to a buffer.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] query                 The buffer to compare the candidates to.
+ * @param[in] query_length          The length of the query.
+ * @param[in] candidates            The buffers to compare the query to.
+ * @param[in] candidate_lengths     Their lengths, or NULL if they are strings.
+ * @param[in] count                 The number of candidates.
+ * @param[in] k                     The number of nearest candidates to find.
+ * @param[out] indices              The indices of the nearest candidates.
+ * @param[out] distances            Their distances to the query, or NULL.
+ *
+ * @returns The number of candidates found.
+ *
+ */
+size_t find_nearest_candidates_n(edit_distance_type_t edit_distance_type, const char* query, size_t query_length, const char* const* candidates, const size_t* candidate_lengths, size_t count, size_t k, size_t* indices, size_t* distances) {
+    k = MIN(k, count);
+
+    if (k == 0) {
+        return 0;
+    }
+
+    edit_distance_batch_t batch;
+
+    initialize_edit_distance_batch(&batch, edit_distance_type, query, query_length, candidates, candidate_lengths, count);
+
+    batch.k = k;
+    batch.nearest_indices = indices;
+    batch.nearest_distances = distances;
+
+    run_edit_distance_batch(&batch);
+
+    free(batch.peq);
+
+    return k;
+}
+
+/**
+ * Find the candidates nearest to a string.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] query                 The string to compare the candidates to.
+ * @param[in] candidates            The strings to compare the query to.
+ * @param[in] count                 The number of candidates.
+ * @param[in] k                     The number of nearest candidates to find.
+ * @param[out] indices              The indices of the nearest candidates.
+ * @param[out] distances            Their distances to the query, or NULL.
+ *
+ * @returns The number of candidates found.
+ *
+ */
+size_t find_nearest_candidates(edit_distance_type_t edit_distance_type, const char* query, const char* const* candidates, size_t count, size_t k, size_t* indices, size_t* distances) {
+    return find_nearest_candidates_n(edit_distance_type, query, string_length(query), candidates, NULL, count, k, indices, distances);
+}
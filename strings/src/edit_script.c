@@ -0,0 +1,454 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ *
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xstrings.h"
+
+#ifndef MAX
+#define MAX(a,b) ((a < b) ? (b) : (a))
+#endif
+
+#ifndef MIN
+#define MIN(a,b) ((a > b) ? (b) : (a))
+#endif
+
+/**
+ * Hirschberg Base Case Size
+ *
+ * The largest number of cells of the dynamic programming
+ * matrix of a subproblem which is solved directly, keeping
+ * the whole matrix and tracing the alignment back through
+ * it, rather than split in two.
+ *
+ * @def HIRSCHBERG_BASE_CASE_CELLS
+ *
+ */
+#ifndef HIRSCHBERG_BASE_CASE_CELLS
+#define HIRSCHBERG_BASE_CASE_CELLS 4096
+#endif
+
+/**
+ * Edit Script Writer
+ *
+ * The writer appends edit operations to the caller's
+ * script, merging each operation into the previous run
+ * when both are of the same type. Runs past the capacity
+ * of the script are counted but not written.
+ *
+ */
+typedef struct {
+    edit_operation_t* script;
+    size_t capacity;
+    size_t count;
+    edit_operation_type_t last;
+} edit_script_writer_t;
+
+/**
+ * Hirschberg State
+ *
+ * The scratch memory shared by every subproblem of the
+ * recursion. The two rows are only used to find the split
+ * point of a subproblem, before either half is solved, so
+ * a single pair serves the whole recursion.
+ *
+ */
+typedef struct {
+    size_t* forward;
+    size_t* reverse;
+    size_t* matrix;
+    unsigned char* trace;
+    size_t substitution_cost;
+    edit_script_writer_t writer;
+} hirschberg_t;
+
+/**
+ * Append Edit Operation
+ *
+ * @param[in,out] writer The writer to append to.
+ * @param[in] type The type of the operation.
+ * @param[in] length The number of characters it spans.
+ *
+ */
+static void append_edit_operation(edit_script_writer_t* writer, edit_operation_type_t type, size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    if ((writer->count > 0) && (writer->last == type)) {
+        if (writer->count <= writer->capacity) {
+            writer->script[writer->count - 1].length += length;
+        }
+
+        return;
+    }
+
+    if (writer->count < writer->capacity) {
+        writer->script[writer->count].type = type;
+        writer->script[writer->count].length = length;
+    }
+
+    writer->last = type;
+    ++writer->count;
+}
+
+/**
+ * Hirschberg Forward Row
+ *
+ * This function computes the last row of the dynamic
+ * programming matrix of a and b, that is, the distance of
+ * a to every prefix of b, keeping a single row in memory.
+ *
+ * @param[in] state The state of the recursion.
+ * @param[in] a The first string.
+ * @param[in] m The length of a.
+ * @param[in] b The second string.
+ * @param[in] n The length of b.
+ * @param[out] row The n+1 distances of a to the prefixes of b.
+ *
+ */
+static void hirschberg_forward_row(const hirschberg_t* state, const char* a, size_t m, const char* b, size_t n, size_t* row) {
+    for (size_t j = 0; j <= n; ++j) {
+        row[j] = j;
+    }
+
+    for (size_t i = 0; i < m; ++i) {
+        size_t diagonal = row[0];
+        row[0] = i + 1;
+
+        for (size_t j = 1; j <= n; ++j) {
+            const size_t above = row[j];
+            const size_t replace = diagonal + ((a[i] == b[j - 1]) ? 0 : state->substitution_cost);
+
+            row[j] = MIN(MIN(above, row[j - 1]) + 1, replace);
+            diagonal = above;
+        }
+    }
+}
+
+/**
+ * Hirschberg Reverse Row
+ *
+ * This function computes the distance of a to every suffix
+ * of b, by running the forward recurrence over both strings
+ * back to front. The distance to the suffix of length j is
+ * left in row[j].
+ *
+ * @param[in] state The state of the recursion.
+ * @param[in] a The first string.
+ * @param[in] m The length of a.
+ * @param[in] b The second string.
+ * @param[in] n The length of b.
+ * @param[out] row The n+1 distances of a to the suffixes of b.
+ *
+ */
+static void hirschberg_reverse_row(const hirschberg_t* state, const char* a, size_t m, const char* b, size_t n, size_t* row) {
+    for (size_t j = 0; j <= n; ++j) {
+        row[j] = j;
+    }
+
+    for (size_t i = m; i-- > 0; ) {
+        size_t diagonal = row[0];
+        row[0] = m - i;
+
+        for (size_t j = 1; j <= n; ++j) {
+            const size_t above = row[j];
+            const size_t replace = diagonal + ((a[i] == b[n - j]) ? 0 : state->substitution_cost);
+
+            row[j] = MIN(MIN(above, row[j - 1]) + 1, replace);
+            diagonal = above;
+        }
+    }
+}
+
+/**
+ * Hirschberg Base Case
+ *
+ * This function aligns two strings whose dynamic
+ * programming matrix has at most HIRSCHBERG_BASE_CASE_CELLS
+ * cells by filling in the whole matrix and tracing an
+ * optimal path back from its last cell. Matches are
+ * preferred over substitutions, and substitutions, when
+ * they are allowed, over insertions and deletions.
+ *
+ * @param[in,out] state The state of the recursion.
+ * @param[in] a The first string.
+ * @param[in] m The length of a.
+ * @param[in] b The second string.
+ * @param[in] n The length of b.
+ *
+ */
+static void hirschberg_base_case(hirschberg_t* state, const char* a, size_t m, const char* b, size_t n) {
+    size_t* matrix = state->matrix;
+    const size_t width = n + 1;
+
+    for (size_t j = 0; j <= n; ++j) {
+        matrix[j] = j;
+    }
+
+    for (size_t i = 1; i <= m; ++i) {
+        size_t* row = matrix + (i * width);
+        const size_t* previous = row - width;
+
+        row[0] = i;
+
+        for (size_t j = 1; j <= n; ++j) {
+            const size_t replace = previous[j - 1] + ((a[i - 1] == b[j - 1]) ? 0 : state->substitution_cost);
+
+            row[j] = MIN(MIN(previous[j], row[j - 1]) + 1, replace);
+        }
+    }
+
+    size_t i = m;
+    size_t j = n;
+    size_t length = 0;
+
+    while ((i > 0) || (j > 0)) {
+        const size_t cell = matrix[(i * width) + j];
+
+        if ((i > 0) && (j > 0) && (a[i - 1] == b[j - 1]) && (cell == matrix[((i - 1) * width) + (j - 1)])) {
+            state->trace[length++] = EDIT_MATCH;
+            --i;
+            --j;
+        } else if ((i > 0) && (j > 0) && (state->substitution_cost == 1) && (cell == matrix[((i - 1) * width) + (j - 1)] + 1)) {
+            state->trace[length++] = EDIT_SUBSTITUTION;
+            --i;
+            --j;
+        } else if ((i > 0) && (cell == matrix[((i - 1) * width) + j] + 1)) {
+            state->trace[length++] = EDIT_DELETION;
+            --i;
+        } else {
+            state->trace[length++] = EDIT_INSERTION;
+            --j;
+        }
+    }
+
+    while (length > 0) {
+        append_edit_operation(&state->writer, (edit_operation_type_t) state->trace[--length], 1);
+    }
+}
+
+/**
+ * Hirschberg Alignment
+ *
+ * This function implements Hirschberg's divide-and-conquer
+ * alignment. The first string is split in half; the last
+ * row of the matrix of its first half against b and that of
+ * its second half against b, both computed in linear
+ * space, give the cost of every way of splitting b between
+ * the two halves, and an optimal alignment passes through
+ * the cheapest split. Both halves are then aligned
+ * recursively, so the alignment takes time proportional to
+ * the product of the lengths, about twice that of the
+ * distance alone, and memory linear in the length of b.
+ *
+ * Subproblems small enough are handed to the base case, and
+ * those in which a is a single character are solved
+ * directly, so that a long b never reaches the base case.
+ *
+ * @param[in,out] state The state of the recursion.
+ * @param[in] a The first string.
+ * @param[in] m The length of a.
+ * @param[in] b The second string.
+ * @param[in] n The length of b.
+ *
+ * @cite hirschberg_linear_1975
+ *
+ */
+static void hirschberg_align(hirschberg_t* state, const char* a, size_t m, const char* b, size_t n) {
+    if ((m == 0) || (n == 0)) {
+        append_edit_operation(&state->writer, EDIT_INSERTION, n);
+        append_edit_operation(&state->writer, EDIT_DELETION, m);
+        return;
+    }
+
+    if (m == 1) {
+        const char* match = memchr(b, a[0], n);
+
+        if (match != NULL) {
+            const size_t offset = (size_t) (match - b);
+
+            append_edit_operation(&state->writer, EDIT_INSERTION, offset);
+            append_edit_operation(&state->writer, EDIT_MATCH, 1);
+            append_edit_operation(&state->writer, EDIT_INSERTION, n - offset - 1);
+        } else if (state->substitution_cost == 1) {
+            append_edit_operation(&state->writer, EDIT_SUBSTITUTION, 1);
+            append_edit_operation(&state->writer, EDIT_INSERTION, n - 1);
+        } else {
+            append_edit_operation(&state->writer, EDIT_DELETION, 1);
+            append_edit_operation(&state->writer, EDIT_INSERTION, n);
+        }
+
+        return;
+    }
+
+    if (m + 1 <= HIRSCHBERG_BASE_CASE_CELLS / (n + 1)) {
+        hirschberg_base_case(state, a, m, b, n);
+        return;
+    }
+
+    const size_t middle = m / 2;
+
+    hirschberg_forward_row(state, a, middle, b, n, state->forward);
+    hirschberg_reverse_row(state, a + middle, m - middle, b, n, state->reverse);
+
+    size_t split = 0;
+    size_t best = state->forward[0] + state->reverse[n];
+
+    for (size_t k = 1; k <= n; ++k) {
+        const size_t cost = state->forward[k] + state->reverse[n - k];
+
+        if (cost < best) {
+            best = cost;
+            split = k;
+        }
+    }
+
+    hirschberg_align(state, a, middle, b, split);
+    hirschberg_align(state, a + middle, m - middle, b + split, n - split);
+}
+
+/**
+ * Calculate the edit script of two buffers, using the given
+ * workspace for scratch memory.
+ *
+ * The common prefix and suffix of both buffers are matched
+ * outright, and the rest is aligned with Hirschberg's
+ * algorithm, drawing two rows of the length of b and the
+ * base case matrix from the workspace. Nothing else is
+ * allocated.
+ *
+ * @param[in,out] workspace         The workspace to draw scratch memory from.
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The source buffer.
+ * @param[in] a_length              The length of a.
+ * @param[in] b                     The target buffer.
+ * @param[in] b_length              The length of b.
+ * @param[out] script               The array to write the runs to.
+ * @param[in] capacity              The number of runs script can hold.
+ *
+ * @returns The number of runs in the edit script, which may
+ * exceed the capacity.
+ *
+ */
+size_t calculate_edit_script_workspace_n(edit_distance_workspace_t* workspace, edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length, edit_operation_t* script, size_t capacity) {
+    hirschberg_t state;
+
+    switch (edit_distance_type) {
+        case LEVENSHTEIN_DISTANCE: {
+            state.substitution_cost = 1;
+        } break;
+
+        case LONGEST_COMMON_SUBSEQUENCE: {
+            state.substitution_cost = 2;
+        } break;
+
+        default: {
+            fprintf(stderr, "[Error] %s\n", "Edit script not available for this metric.");
+            return 0;
+        }
+    }
+
+    state.writer.script = script;
+    state.writer.capacity = capacity;
+    state.writer.count = 0;
+    state.writer.last = EDIT_MATCH;
+
+    size_t prefix = 0;
+
+    while ((prefix < a_length) && (prefix < b_length) && (a[prefix] == b[prefix])) {
+        ++prefix;
+    }
+
+    size_t suffix = 0;
+
+    while ((suffix < a_length - prefix) && (suffix < b_length - prefix) && (a[a_length - suffix - 1] == b[b_length - suffix - 1])) {
+        ++suffix;
+    }
+
+    const size_t m = a_length - prefix - suffix;
+    const size_t n = b_length - prefix - suffix;
+
+    const size_t cells = HIRSCHBERG_BASE_CASE_CELLS;
+    size_t* memory = reserve_edit_distance_workspace(workspace, (sizeof (size_t) * ((2 * (n + 1)) + cells)) + cells);
+
+    state.forward = memory;
+    state.reverse = memory + (n + 1);
+    state.matrix = memory + (2 * (n + 1));
+    state.trace = (unsigned char*) (state.matrix + cells);
+
+    append_edit_operation(&state.writer, EDIT_MATCH, prefix);
+    hirschberg_align(&state, a + prefix, m, b + prefix, n);
+    append_edit_operation(&state.writer, EDIT_MATCH, suffix);
+
+    return state.writer.count;
+}
+
+/**
+ * Calculate the edit script of two buffers.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The source buffer.
+ * @param[in] a_length              The length of a.
+ * @param[in] b                     The target buffer.
+ * @param[in] b_length              The length of b.
+ * @param[out] script               The array to write the runs to.
+ * @param[in] capacity              The number of runs script can hold.
+ *
+ * @returns The number of runs in the edit script, which may
+ * exceed the capacity.
+ *
+ */
+size_t calculate_edit_script_n(edit_distance_type_t edit_distance_type, const char* a, size_t a_length, const char* b, size_t b_length, edit_operation_t* script, size_t capacity) {
+    edit_distance_workspace_t* workspace = create_edit_distance_workspace(0);
+
+    const size_t count = calculate_edit_script_workspace_n(workspace, edit_distance_type, a, a_length, b, b_length, script, capacity);
+
+    free_edit_distance_workspace(workspace);
+
+    return count;
+}
+
+/**
+ * Calculate the edit script of two strings.
+ *
+ * @param[in] edit_distance_type    The edit distance metric to use.
+ * @param[in] a                     The source string.
+ * @param[in] b                     The target string.
+ * @param[out] script               The array to write the runs to.
+ * @param[in] capacity              The number of runs script can hold.
+ *
+ * @returns The number of runs in the edit script, which may
+ * exceed the capacity.
+ *
+ */
+size_t calculate_edit_script(edit_distance_type_t edit_distance_type, const char* a, const char* b, edit_operation_t* script, size_t capacity) {
+    return calculate_edit_script_n(edit_distance_type, a, string_length(a), b, string_length(b), script, capacity);
+}
@@ -32,6 +32,23 @@
 
 #include "xstrings.h"
 
+#ifndef MAX
+#define MAX(a,b) ((a < b) ? (b) : (a))
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+
+/**
+ * This macro is defined when the vectorized implementations
+ * of the generic SIMD string search are available.
+ *
+ * @def XLIBS_GENERIC_SIMD_STRING_SEARCH
+ *
+ */
+#define XLIBS_GENERIC_SIMD_STRING_SEARCH
+#endif
+
 /**
  * Naive String Search Algorithm
  *
@@ -40,43 +57,155 @@
  * Algorithms</I>, by Cormen, et. al., this algorithm has a
  * runtime complexity of \f$O\left(\left(n-m+1\right)m\right)\f$.
  *
- * @param[in] needle The substring to search for.
+ * @param[in] pattern The compiled substring to search for.
  * @param[in] haystack The string to look for the substring in.
+ * @param[in] h The length of the haystack.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
  *
- * @returns Pointer to the start of the substring within the
- * haystack. If the needle is not found in the haystack, the
+ * @returns Pointer to the match at which the callback
+ * stopped the search. If the callback never stopped it, the
  * returned pointer will be equal to NULL.
  *
  * @cite cormen_introduction_2009
  *
  */
-static const char* naive_string_search(const char* needle, const char* haystack) {
-    size_t n = strlen(needle);
-    size_t h = strlen(haystack);
+static const char* naive_string_search(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    size_t n = pattern->length;
 
-    for (size_t i = 0; i < h - n; ++i) {
-        if (needle[0] == haystack[0 + i]) {
-            for (size_t j = 1; j < n; ++j) {
-                if (needle[j] != haystack[j + i]) {
-                    break;
-                }
+    for (size_t i = 0; i <= h - n; ++i) {
+        size_t j = 0;
 
-                if (j == (n -1)) {
-                    return haystack + i;
-                }
-            }
+        while ((j < n) && (needle[j] == haystack[j + i])) {
+            ++j;
+        }
+
+        if ((j == n) && (callback(i, context) != 0)) {
+            return haystack + i;
         }
     }
     
     return NULL;
 }
 
-static const char* rabin_karp_string_search(const char* needle, const char* haystack) {
+/**
+ * Rabin-Karp String Search
+ *
+ * This function slides a window the length of the needle
+ * across the haystack, maintaining the rolling hash of the
+ * characters within it. The window is only compared against
+ * the needle character by character when its hash equals
+ * the hash of the needle, which was computed when the
+ * pattern was compiled.
+ *
+ * @param[in] pattern The compiled substring to search for.
+ * @param[in] haystack The text to look for the substring in.
+ * @param[in] h The length of the haystack.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns Pointer to the match at which the callback
+ * stopped the search. If the callback never stopped it, the
+ * returned pointer will be equal to NULL.
+ *
+ * @cite cormen_introduction_2009
+ *
+ */
+static const char* rabin_karp_string_search(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    const size_t m = pattern->length;
+    const size_t high_order = pattern->high_order;
+
+    size_t hash = rabin_karp_hash(haystack, m);
+
+    for (size_t i = 0; ; ++i) {
+        if ((hash == pattern->hash) && (memcmp(haystack + i, needle, m) == 0) && (callback(i, context) != 0)) {
+            return haystack + i;
+        }
+
+        if (i + m >= h) {
+            break;
+        }
+
+        hash = rabin_karp_roll(hash, haystack[i], haystack[i + m], high_order);
+    }
+
     return NULL;
 }
 
-static const char* finite_automaton_string_search(const char* needle, const char* haystack) {
-    return NULL;
+/**
+ * Finite Automaton Match
+ *
+ * This structure adapts the callback of a single-needle
+ * search to the callback of the automaton, and records the
+ * match at which the search was stopped, if any.
+ *
+ * @struct finite_automaton_match_t
+ *
+ */
+typedef struct {
+    substring_match_callback_t callback;
+    void* context;
+    const char* haystack;
+    const char* match;
+} finite_automaton_match_t;
+
+/**
+ * Forward an automaton match to a single-needle callback.
+ *
+ * @param[in] needle_index  Unused, since there is only one needle.
+ * @param[in] offset        The offset at which the match begins.
+ * @param[in] context       The finite automaton match structure.
+ *
+ * @returns The return value of the wrapped callback.
+ *
+ */
+static int forward_finite_automaton_match(size_t needle_index, size_t offset, void* context) {
+    finite_automaton_match_t* match = context;
+
+    (void) needle_index;
+
+    if (match->callback(offset, match->context) != 0) {
+        match->match = match->haystack + offset;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Finite Automaton String Search
+ *
+ * This function runs the string-matching automaton built
+ * for the needle when the pattern was compiled over the
+ * haystack, examining each character of the haystack
+ * exactly once.
+ *
+ * @param[in] pattern The compiled substring to search for.
+ * @param[in] haystack The text to look for the substring in.
+ * @param[in] h The length of the haystack.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns Pointer to the match at which the callback
+ * stopped the search. If the callback never stopped it, the
+ * returned pointer will be equal to NULL.
+ *
+ * @cite cormen_introduction_2009
+ *
+ */
+static const char* finite_automaton_string_search(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    finite_automaton_match_t match = {
+        .callback = callback,
+        .context = context,
+        .haystack = haystack,
+        .match = NULL
+    };
+
+    run_aho_corasick_automaton(pattern->automaton, haystack, h, forward_finite_automaton_match, &match);
+
+    return match.match;
 }
 
 /**
@@ -87,6 +216,7 @@ static const char* finite_automaton_string_search(const char* needle, const char
  * algorithm.
  *
  * @param[in] needle The substring to search for.
+ * @param[in] m The length of the needle.
  *
  * @returns The array of pre-computed shifts required by the
  * Knuth-Morris-Pratt algorithm.
@@ -94,9 +224,7 @@ static const char* finite_automaton_string_search(const char* needle, const char
  * @cite cormen_introduction_2009
  *
  */
-static size_t* knuth_morris_pratt_compute_prefix_function(const char* needle) {
-    size_t m = strlen(needle);
-
+static size_t* knuth_morris_pratt_compute_prefix_function(const char* needle, size_t m) {
     size_t* p = malloc(sizeof (size_t) * (m + 1));
 
     if (p == NULL) {
@@ -112,7 +240,7 @@ static size_t* knuth_morris_pratt_compute_prefix_function(const char* needle) {
 
     for (size_t q = 1; q < m; ++q) {
         while ((k > 0) && (needle[k] != needle[q])) {
-            k = p[k];
+            k = p[k - 1];
         }
 
         if (needle[k] == needle[q]) {
@@ -134,25 +262,28 @@ static size_t* knuth_morris_pratt_compute_prefix_function(const char* needle) {
  * Edition of <I>Introduction to Algorithms</I> by Cormen,
  * et al.
  *
- * @param[in] needle The substring to search for.
+ * @param[in] pattern The compiled substring to search for.
  * @param[in] haystack The text to look for the substring in.
+ * @param[in] h The length of the haystack.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
  *
- * @returns Pointer to the start of the substring within the
- * haystack. If the needle is not found in the haystack, the
+ * @returns Pointer to the match at which the callback
+ * stopped the search. If the callback never stopped it, the
  * returned pointer will be equal to NULL.
  *
  * @cite cormen_introduction_2009
  *
  */
-static const char* knuth_morris_pratt_string_search(const char* needle, const char* haystack) {
-    size_t m = strlen(needle);
-    size_t n = strlen(haystack);
-    size_t*p = knuth_morris_pratt_compute_prefix_function(needle);
+static const char* knuth_morris_pratt_string_search(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    const size_t* p = pattern->prefix;
+    size_t m = pattern->length;
     size_t q = 0;
 
-    for (size_t i = 0; i < n; ++i) {
+    for (size_t i = 0; i < h; ++i) {
         while ((q > 0) && (needle[q] != haystack[i])) {
-            q = p[q];
+            q = p[q - 1];
         }
 
         if (needle[q] == haystack[i]) {
@@ -160,8 +291,11 @@ static const char* knuth_morris_pratt_string_search(const char* needle, const ch
         }
 
         if (q == m) {
-            free(p);
-            return haystack + i - m + 1;
+            q = p[m - 1];
+
+            if (callback(i - m + 1, context) != 0) {
+                return haystack + i - m + 1;
+            }
         }
     }
 
@@ -169,55 +303,1240 @@ static const char* knuth_morris_pratt_string_search(const char* needle, const ch
 }
 
 /**
- * String Search Function
+ * Two-Way Critical Factorization
  *
- * This type alias allows us to return a function pointer
- * from the get_string_search_function(), making the string
- * searching API much more convenient, and the codebase much
- * easier to maintain.
+ * This function computes a critical factorization of the
+ * needle, splitting it into a left half u and a right half
+ * v such that the local period at the split equals the
+ * global period of the needle. The split is found as the
+ * later of the starting positions of the maximal suffixes
+ * of the needle under the byte order and its reverse,
+ * either of which is computed in linear time using only a
+ * constant number of variables.
  *
- * @typedef string_search_function_t
+ * @param[in] needle The substring to search for.
+ * @param[in] m The length of the needle.
+ * @param[out] period The period of the right half of the needle.
+ *
+ * @returns The length of the left half of the needle.
+ *
+ * @cite crochemore_two-way_1991
  *
  */
-typedef const char* (*string_search_function_t)(const char*, const char*);
+static size_t two_way_critical_factorization(const unsigned char* needle, size_t m, size_t* period) {
+    size_t max_suffix = (size_t) -1;
+    size_t j = 0;
+    size_t k = 1;
+    size_t p = 1;
+
+    while (j + k < m) {
+        const unsigned char a = needle[j + k];
+        const unsigned char b = needle[max_suffix + k];
+
+        if (a < b) {
+            j += k;
+            k = 1;
+            p = j - max_suffix;
+        } else if (a == b) {
+            if (k != p) {
+                ++k;
+            } else {
+                j += p;
+                k = 1;
+            }
+        } else {
+            max_suffix = j++;
+            k = p = 1;
+        }
+    }
+
+    *period = p;
+
+    size_t max_suffix_reverse = (size_t) -1;
+    j = 0;
+    k = 1;
+    p = 1;
+
+    while (j + k < m) {
+        const unsigned char a = needle[j + k];
+        const unsigned char b = needle[max_suffix_reverse + k];
+
+        if (b < a) {
+            j += k;
+            k = 1;
+            p = j - max_suffix_reverse;
+        } else if (a == b) {
+            if (k != p) {
+                ++k;
+            } else {
+                j += p;
+                k = 1;
+            }
+        } else {
+            max_suffix_reverse = j++;
+            k = p = 1;
+        }
+    }
+
+    /**
+     * Both maximal suffix positions start at -1, so they are
+     * compared after adding one to avoid the wraparound.
+     *
+     */
+    if (max_suffix_reverse + 1 < max_suffix + 1) {
+        return max_suffix + 1;
+    }
+
+    *period = p;
+
+    return max_suffix_reverse + 1;
+}
 
 /**
- * Get String Search Function
+ * Two-Way String Search Preprocessing
  *
- * This function takes the argument specified by the user in
- * the call to find_substring(), and it returns a function
- * pointer to the correct string searching function.
+ * This function stores the critical factorization of the
+ * needle in the pattern, and it determines which variant of
+ * the search applies. If the left half of the needle is a
+ * suffix of its first period, the needle is periodic, and
+ * the search shifts by exactly one period after matching
+ * the right half, remembering how much of the left half is
+ * already known to match. Otherwise, any shift larger than
+ * both halves is safe, and nothing needs remembering.
  *
- * @param[in] algorithm The desired string searching algorithm.
+ * No memory is allocated, so the Two-Way search may be used
+ * from signal handlers and other allocation-sensitive code.
  *
- * @returns Function pointer to the appropriate string
- * searching function.
+ * @param[in,out] pattern The pattern to preprocess.
+ *
+ * @cite crochemore_two-way_1991
  *
  */
-string_search_function_t get_string_search_function(string_search_algorithm_t algorithm) {
-    switch (algorithm) {
-        case NAIVE_STRING_SEARCH: return naive_string_search;
-        case RABIN_KARP_STRING_SEARCH: return rabin_karp_string_search;
-        case FINITE_AUTOMATON_STRING_SEARCH: return finite_automaton_string_search;
-        case KNUTH_MORRIS_PRATT_STRING_SEARCH: return knuth_morris_pratt_string_search;
+static void two_way_preprocess(search_pattern_t* pattern) {
+    const unsigned char* needle = (const unsigned char*) pattern->needle;
+    const size_t m = pattern->length;
+
+    size_t period = 0;
+    const size_t critical = two_way_critical_factorization(needle, m, &period);
+
+    pattern->critical = critical;
+
+    if ((critical + period <= m) && (memcmp(needle, needle + period, critical) == 0)) {
+        pattern->period = period;
+        pattern->periodic = 1;
+    } else {
+        pattern->period = MAX(critical, m - critical) + 1;
+        pattern->periodic = 0;
     }
-    
+}
+
+/**
+ * Two-Way String Search
+ *
+ * This function searches the haystack using the Two-Way
+ * algorithm of Crochemore and Perrin. At each alignment,
+ * the right half of the needle is compared left to right,
+ * and then the left half is compared right to left. A
+ * mismatch in the right half shifts the needle past the
+ * mismatched character, and a full match shifts it by the
+ * period computed during preprocessing. The search runs in
+ * linear time, like Knuth-Morris-Pratt, but it only needs a
+ * constant amount of extra space.
+ *
+ * @param[in] pattern The compiled substring to search for.
+ * @param[in] haystack The text to look for the substring in.
+ * @param[in] h The length of the haystack.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns Pointer to the match at which the callback
+ * stopped the search. If the callback never stopped it, the
+ * returned pointer will be equal to NULL.
+ *
+ * @cite crochemore_two-way_1991
+ *
+ */
+static const char* two_way_string_search(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    const size_t m = pattern->length;
+    const size_t critical = pattern->critical;
+    const size_t period = pattern->period;
+
+    size_t j = 0;
+
+    if (pattern->periodic) {
+        /**
+         * The number of leading characters of the needle
+         * already known to match at the current alignment.
+         *
+         */
+        size_t memory = 0;
+
+        while (j <= h - m) {
+            size_t i = MAX(critical, memory);
+
+            while ((i < m) && (needle[i] == haystack[i + j])) {
+                ++i;
+            }
+
+            if (i < m) {
+                j += i - critical + 1;
+                memory = 0;
+                continue;
+            }
+
+            i = critical;
+
+            while ((i > memory) && (needle[i - 1] == haystack[i - 1 + j])) {
+                --i;
+            }
+
+            if ((i <= memory) && (callback(j, context) != 0)) {
+                return haystack + j;
+            }
+
+            j += period;
+            memory = m - period;
+        }
+    } else {
+        while (j <= h - m) {
+            size_t i = critical;
+
+            while ((i < m) && (needle[i] == haystack[i + j])) {
+                ++i;
+            }
+
+            if (i < m) {
+                j += i - critical + 1;
+                continue;
+            }
+
+            i = critical;
+
+            while ((i > 0) && (needle[i - 1] == haystack[i - 1 + j])) {
+                --i;
+            }
+
+            if ((i == 0) && (callback(j, context) != 0)) {
+                return haystack + j;
+            }
+
+            j += period;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Bad-Character Shift Preprocessing
+ *
+ * This function allocates and initializes the table of
+ * shifts shared by the Boyer-Moore and Horspool algorithms.
+ * The shift for a byte is the distance from its last
+ * occurrence in the needle, not counting the last position,
+ * to the end of the needle, or the length of the needle if
+ * it does not occur there.
+ *
+ * @param[in] needle The substring to search for.
+ * @param[in] m The length of the needle.
+ *
+ * @returns The table of shifts for each byte value.
+ *
+ * @cite horspool_practical_1980
+ *
+ */
+static size_t* bad_character_compute_shift_function(const char* needle, size_t m) {
+    size_t* skip = malloc(sizeof (size_t) * 256);
+
+    if (skip == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t c = 0; c < 256; ++c) {
+        skip[c] = m;
+    }
+
+    for (size_t i = 0; i + 1 < m; ++i) {
+        skip[(unsigned char) needle[i]] = m - 1 - i;
+    }
+
+    return skip;
+}
+
+/**
+ * Boyer-Moore Good-Suffix Preprocessing
+ *
+ * This function allocates and initializes the strong
+ * good-suffix shift table of the Boyer-Moore algorithm.
+ * Entry i holds the shift to apply when the needle has
+ * matched the haystack from its end back to position i+1,
+ * and mismatched at position i: the smallest shift that
+ * realigns the matched suffix with an earlier occurrence of
+ * it preceded by a different character, or with a prefix of
+ * the needle. The computation follows Charras and Lecroq.
+ *
+ * @param[in] needle The substring to search for.
+ * @param[in] m The length of the needle.
+ *
+ * @returns The table of good-suffix shifts.
+ *
+ * @cite charras_handbook_2004
+ *
+ */
+static size_t* boyer_moore_compute_good_suffix_function(const char* needle, size_t m) {
+    size_t* good_suffix = malloc(sizeof (size_t) * m);
+    ptrdiff_t* suffix = malloc(sizeof (ptrdiff_t) * m);
+
+    if ((good_suffix == NULL) || (suffix == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    const ptrdiff_t n = (ptrdiff_t) m;
+
     /**
-     * Since the passed-in value was not recognized, use the
-     * default string searching algorithm.
-     *
-     * @todo Allow for the configuration of a default
-     * algorithm during library configuration.
+     * suffix[i] is the length of the longest substring of the
+     * needle ending at position i that is also a suffix of it.
      *
      */
-    return knuth_morris_pratt_string_search;
+    ptrdiff_t f = 0;
+    ptrdiff_t g = n - 1;
+
+    suffix[n - 1] = n;
+
+    for (ptrdiff_t i = n - 2; i >= 0; --i) {
+        if ((i > g) && (suffix[i + n - 1 - f] < i - g)) {
+            suffix[i] = suffix[i + n - 1 - f];
+        } else {
+            if (i < g) {
+                g = i;
+            }
+
+            f = i;
+
+            while ((g >= 0) && (needle[g] == needle[g + n - 1 - f])) {
+                --g;
+            }
+
+            suffix[i] = f - g;
+        }
+    }
+
+    for (ptrdiff_t i = 0; i < n; ++i) {
+        good_suffix[i] = m;
+    }
+
+    ptrdiff_t j = 0;
+
+    for (ptrdiff_t i = n - 1; i >= 0; --i) {
+        if (suffix[i] == i + 1) {
+            for (; j < n - 1 - i; ++j) {
+                if (good_suffix[j] == m) {
+                    good_suffix[j] = (size_t) (n - 1 - i);
+                }
+            }
+        }
+    }
+
+    for (ptrdiff_t i = 0; i <= n - 2; ++i) {
+        good_suffix[n - 1 - suffix[i]] = (size_t) (n - 1 - i);
+    }
+
+    free(suffix);
+
+    return good_suffix;
+}
+
+/**
+ * Boyer-Moore String Search
+ *
+ * This function compares the needle against the haystack
+ * from right to left at each alignment. On a mismatch, it
+ * shifts the needle by the larger of the bad-character and
+ * good-suffix shifts, both precomputed when the pattern was
+ * compiled. Long needles often allow shifts of nearly their
+ * full length, so only a fraction of the haystack is read.
+ *
+ * @param[in] pattern The compiled substring to search for.
+ * @param[in] haystack The text to look for the substring in.
+ * @param[in] h The length of the haystack.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns Pointer to the match at which the callback
+ * stopped the search. If the callback never stopped it, the
+ * returned pointer will be equal to NULL.
+ *
+ * @cite boyer_fast_1977
+ *
+ */
+static const char* boyer_moore_string_search(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    const size_t m = pattern->length;
+    const size_t* skip = pattern->skip;
+    const size_t* good_suffix = pattern->good_suffix;
+
+    size_t j = 0;
+
+    while (j <= h - m) {
+        size_t i = m;
+
+        while ((i > 0) && (needle[i - 1] == haystack[i - 1 + j])) {
+            --i;
+        }
+
+        if (i == 0) {
+            if (callback(j, context) != 0) {
+                return haystack + j;
+            }
+
+            j += good_suffix[0];
+            continue;
+        }
+
+        /**
+         * The bad-character shift aligns the mismatched byte
+         * of the haystack with its last occurrence in the
+         * needle, which may lie to the right of the mismatch,
+         * in which case the good-suffix shift always wins.
+         *
+         */
+        const size_t mismatch = i - 1;
+        const size_t bad_character = skip[(unsigned char) haystack[mismatch + j]];
+        const size_t matched = m - 1 - mismatch;
+
+        if (bad_character > matched) {
+            j += MAX(good_suffix[mismatch], bad_character - matched);
+        } else {
+            j += good_suffix[mismatch];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Horspool String Search
+ *
+ * This function implements Horspool's simplification of
+ * the Boyer-Moore algorithm. At each alignment, the last
+ * byte of the window is compared first, then the rest of
+ * the needle. Whatever the outcome, the needle is shifted
+ * by the bad-character shift of the last byte of the
+ * window, so the inner loop is short and branch-light.
+ *
+ * @param[in] pattern The compiled substring to search for.
+ * @param[in] haystack The text to look for the substring in.
+ * @param[in] h The length of the haystack.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns Pointer to the match at which the callback
+ * stopped the search. If the callback never stopped it, the
+ * returned pointer will be equal to NULL.
+ *
+ * @cite horspool_practical_1980
+ *
+ */
+static const char* horspool_string_search(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    const size_t m = pattern->length;
+    const size_t* skip = pattern->skip;
+    const char last = needle[m - 1];
+
+    size_t j = 0;
+
+    while (j <= h - m) {
+        const char c = haystack[j + m - 1];
+
+        if ((c == last) && (memcmp(haystack + j, needle, m - 1) == 0) && (callback(j, context) != 0)) {
+            return haystack + j;
+        }
+
+        j += skip[(unsigned char) c];
+    }
+
+    return NULL;
+}
+
+#ifdef XLIBS_GENERIC_SIMD_STRING_SEARCH
+
+/**
+ * Generic SIMD String Search Tail
+ *
+ * This function checks the candidate positions left over
+ * once fewer than a full vector of them remain, which is
+ * the only part of the generic SIMD search that proceeds
+ * one position at a time.
+ *
+ * @param[in] pattern The compiled substring to search for.
+ * @param[in] haystack The text to look for the substring in.
+ * @param[in] h The length of the haystack.
+ * @param[in] i The first candidate position left to check.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns Pointer to the match at which the callback
+ * stopped the search, or NULL if it never did.
+ *
+ */
+static const char* generic_simd_string_search_tail(const search_pattern_t* pattern, const char* haystack, size_t h, size_t i, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    const size_t m = pattern->length;
+
+    for (; i + m <= h; ++i) {
+        if ((haystack[i] == needle[0]) && (haystack[i + m - 1] == needle[m - 1]) && (memcmp(haystack + i, needle, m) == 0) && (callback(i, context) != 0)) {
+            return haystack + i;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Generic SIMD String Search (SSE2)
+ *
+ * This function implements the "generic SIMD" substring
+ * search described by Wojciech Mula. The first and last
+ * bytes of the needle are broadcast to every lane of a
+ * vector register, and they are compared against the bytes
+ * of the haystack at offsets 0 and m-1 from each of the
+ * candidate positions in a block. The full needle is only
+ * compared at the positions where both bytes match, so the
+ * haystack is filtered a whole vector at a time with no
+ * data-dependent branches in the common case.
+ *
+ * All loads are unaligned but lie entirely within the
+ * haystack; the positions too close to its end for a full
+ * vector load are checked by generic_simd_string_search_tail().
+ *
+ * @param[in] pattern The compiled substring to search for.
+ * @param[in] haystack The text to look for the substring in.
+ * @param[in] h The length of the haystack.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns Pointer to the match at which the callback
+ * stopped the search. If the callback never stopped it, the
+ * returned pointer will be equal to NULL.
+ *
+ */
+__attribute__((target("sse2")))
+static const char* generic_simd_string_search_sse2(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    const size_t m = pattern->length;
+
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m - 1]);
+
+    size_t i = 0;
+
+    for (; i + m + 15 <= h; i += 16) {
+        const __m128i block_first = _mm_loadu_si128((const __m128i*) (haystack + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i*) (haystack + i + m - 1));
+
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+
+        while (mask != 0) {
+            const size_t candidate = i + __builtin_ctz(mask);
+
+            if ((memcmp(haystack + candidate, needle, m) == 0) && (callback(candidate, context) != 0)) {
+                return haystack + candidate;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    return generic_simd_string_search_tail(pattern, haystack, h, i, callback, context);
+}
+
+/**
+ * Generic SIMD String Search (AVX2)
+ *
+ * @see generic_simd_string_search_sse2()
+ *
+ */
+__attribute__((target("avx2")))
+static const char* generic_simd_string_search_avx2(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    const size_t m = pattern->length;
+
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+
+    size_t i = 0;
+
+    for (; i + m + 31 <= h; i += 32) {
+        const __m256i block_first = _mm256_loadu_si256((const __m256i*) (haystack + i));
+        const __m256i block_last = _mm256_loadu_si256((const __m256i*) (haystack + i + m - 1));
+
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last)));
+
+        while (mask != 0) {
+            const size_t candidate = i + __builtin_ctz(mask);
+
+            if ((memcmp(haystack + candidate, needle, m) == 0) && (callback(candidate, context) != 0)) {
+                return haystack + candidate;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    return generic_simd_string_search_tail(pattern, haystack, h, i, callback, context);
+}
+
+/**
+ * Generic SIMD String Search (AVX-512BW)
+ *
+ * @see generic_simd_string_search_sse2()
+ *
+ */
+__attribute__((target("avx512f,avx512bw")))
+static const char* generic_simd_string_search_avx512bw(const search_pattern_t* pattern, const char* haystack, size_t h, substring_match_callback_t callback, void* context) {
+    const char* needle = pattern->needle;
+    const size_t m = pattern->length;
+
+    const __m512i first = _mm512_set1_epi8(needle[0]);
+    const __m512i last = _mm512_set1_epi8(needle[m - 1]);
+
+    size_t i = 0;
+
+    for (; i + m + 63 <= h; i += 64) {
+        const __m512i block_first = _mm512_loadu_si512((const void*) (haystack + i));
+        const __m512i block_last = _mm512_loadu_si512((const void*) (haystack + i + m - 1));
+
+        uint64_t mask = (uint64_t) (_mm512_cmpeq_epi8_mask(first, block_first) & _mm512_cmpeq_epi8_mask(last, block_last));
+
+        while (mask != 0) {
+            const size_t candidate = i + __builtin_ctzll(mask);
+
+            if ((memcmp(haystack + candidate, needle, m) == 0) && (callback(candidate, context) != 0)) {
+                return haystack + candidate;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    return generic_simd_string_search_tail(pattern, haystack, h, i, callback, context);
+}
+
+#endif /** XLIBS_GENERIC_SIMD_STRING_SEARCH */
+
+/**
+ * String Search Function
+ *
+ * This type alias allows us to return a function pointer
+ * from the get_string_search_function(), making the string
+ * searching API much more convenient, and the codebase much
+ * easier to maintain.
+ *
+ * Every searching function reports each occurrence of the
+ * needle, overlapping ones included, to the callback in
+ * order of increasing offset, and it stops as soon as the
+ * callback returns a nonzero value. Looking for the first
+ * match alone is then simply a matter of using a callback
+ * that always stops, and looking for all of them takes a
+ * single pass over the haystack.
+ *
+ * @typedef string_search_function_t
+ *
+ */
+typedef const char* (*string_search_function_t)(const search_pattern_t*, const char*, size_t, substring_match_callback_t, void*);
+
+/**
+ * Select Generic SIMD String Search Function
+ *
+ * This function returns the widest implementation of the
+ * generic SIMD string search supported by the host, or the
+ * naive string search if none of them are.
+ *
+ * @returns Function pointer to the appropriate string
+ * searching function.
+ *
+ */
+static string_search_function_t select_generic_simd_string_search_function(void) {
+#ifdef XLIBS_GENERIC_SIMD_STRING_SEARCH
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512bw")) {
+        return generic_simd_string_search_avx512bw;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return generic_simd_string_search_avx2;
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return generic_simd_string_search_sse2;
+    }
+#endif
+
+    return naive_string_search;
+}
+
+/**
+ * The generic SIMD string search function selected for the
+ * host, or NULL until the first search selects it.
+ *
+ */
+static string_search_function_t generic_simd_string_search_function = NULL;
+
+/**
+ * Get Generic SIMD String Search Function
+ *
+ * The host is only inspected by the first call, whose
+ * choice every later call reuses. Threads racing through
+ * the first call all make the same choice, so the pointer
+ * only needs to be read and written atomically.
+ *
+ * @returns Function pointer to the appropriate string
+ * searching function.
+ *
+ */
+static string_search_function_t get_generic_simd_string_search_function(void) {
+    string_search_function_t function = __atomic_load_n(&generic_simd_string_search_function, __ATOMIC_RELAXED);
+
+    if (function == NULL) {
+        function = select_generic_simd_string_search_function();
+        __atomic_store_n(&generic_simd_string_search_function, function, __ATOMIC_RELAXED);
+    }
+
+    return function;
+}
+
+/**
+ * Get String Search Function
+ *
+ * This function takes the argument specified by the user in
+ * the call to find_substring(), and it returns a function
+ * pointer to the correct string searching function.
+ *
+ * @param[in] algorithm The desired string searching algorithm.
+ *
+ * @returns Function pointer to the appropriate string
+ * searching function.
+ *
+ */
+string_search_function_t get_string_search_function(string_search_algorithm_t algorithm) {
+    switch (algorithm) {
+        case NAIVE_STRING_SEARCH: return naive_string_search;
+        case RABIN_KARP_STRING_SEARCH: return rabin_karp_string_search;
+        case FINITE_AUTOMATON_STRING_SEARCH: return finite_automaton_string_search;
+        case KNUTH_MORRIS_PRATT_STRING_SEARCH: return knuth_morris_pratt_string_search;
+        case GENERIC_SIMD_STRING_SEARCH: return get_generic_simd_string_search_function();
+        case TWO_WAY_STRING_SEARCH: return two_way_string_search;
+        case BOYER_MOORE_STRING_SEARCH: return boyer_moore_string_search;
+        case HORSPOOL_STRING_SEARCH: return horspool_string_search;
+    }
+    
+    /**
+     * Since the passed-in value was not recognized, use the
+     * default string searching algorithm. The Two-Way search
+     * is linear in the worst case, like Knuth-Morris-Pratt,
+     * but it never allocates memory.
+     *
+     * @todo Allow for the configuration of a default
+     * algorithm during library configuration.
+     *
+     */
+    return two_way_string_search;
+}
+
+/**
+ * Initialize Search Pattern
+ *
+ * This function selects the searching function for the
+ * requested algorithm and runs whatever preprocessing that
+ * function requires. The needle is referenced, not copied,
+ * so it must outlive the pattern.
+ *
+ * @param[out] pattern The pattern to initialize.
+ * @param[in] algorithm The desired string searching algorithm.
+ * @param[in] needle The substring to search for.
+ * @param[in] length The length of the needle.
+ *
+ */
+static void initialize_search_pattern(search_pattern_t* pattern, string_search_algorithm_t algorithm, const char* needle, size_t length) {
+    pattern->search = get_string_search_function(algorithm);
+    pattern->needle = needle;
+    pattern->length = length;
+    pattern->prefix = NULL;
+    pattern->hash = 0;
+    pattern->high_order = 0;
+    pattern->automaton = NULL;
+    pattern->critical = 0;
+    pattern->period = 0;
+    pattern->periodic = 0;
+    pattern->skip = NULL;
+    pattern->good_suffix = NULL;
+
+    if (pattern->search == knuth_morris_pratt_string_search) {
+        pattern->prefix = knuth_morris_pratt_compute_prefix_function(needle, length);
+    }
+
+    if (pattern->search == rabin_karp_string_search) {
+        pattern->hash = rabin_karp_hash(needle, length);
+        pattern->high_order = rabin_karp_high_order(length);
+    }
+
+    if (pattern->search == finite_automaton_string_search) {
+        pattern->automaton = build_aho_corasick_automaton(&needle, &length, 1);
+    }
+
+    if (pattern->search == two_way_string_search) {
+        two_way_preprocess(pattern);
+    }
+
+    if ((pattern->search == boyer_moore_string_search) || (pattern->search == horspool_string_search)) {
+        pattern->skip = bad_character_compute_shift_function(needle, length);
+    }
+
+    if ((pattern->search == boyer_moore_string_search) && (length > 0)) {
+        pattern->good_suffix = boyer_moore_compute_good_suffix_function(needle, length);
+    }
+}
+
+/**
+ * Release Search Pattern
+ *
+ * This function frees the preprocessing tables owned by the
+ * pattern, but not the pattern itself.
+ *
+ * @param[in] pattern The pattern whose tables to release.
+ *
+ */
+static void release_search_pattern(search_pattern_t* pattern) {
+    free(pattern->prefix);
+    pattern->prefix = NULL;
+
+    free_aho_corasick_automaton(pattern->automaton);
+    pattern->automaton = NULL;
+
+    free(pattern->skip);
+    pattern->skip = NULL;
+
+    free(pattern->good_suffix);
+    pattern->good_suffix = NULL;
+}
+
+/**
+ * Compile a length-delimited search pattern.
+ *
+ * This function preprocesses the first needle_length bytes
+ * of the needle for the specified algorithm. The needle
+ * need not be null-terminated, and it may contain null
+ * bytes.
+ *
+ * @param[in] algorithm     The algorithm to use for the search.
+ * @param[in] needle        The substring to look for.
+ * @param[in] needle_length The length of the needle.
+ *
+ * @returns Pointer to the compiled pattern, which must be
+ * released using free_search_pattern().
+ *
+ */
+search_pattern_t* compile_search_pattern_n(string_search_algorithm_t algorithm, const char* needle, size_t needle_length) {
+    /**
+     * The needle is copied into the same allocation as the
+     * pattern itself, so the pattern remains valid even if
+     * the caller's copy of the needle does not.
+     *
+     */
+    search_pattern_t* pattern = malloc(sizeof (search_pattern_t) + needle_length + 1);
+
+    if (pattern == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    char* copy = (char*) (pattern + 1);
+    memcpy(copy, needle, needle_length);
+    copy[needle_length] = '\0';
+
+    initialize_search_pattern(pattern, algorithm, copy, needle_length);
+
+    return pattern;
+}
+
+/**
+ * Compile a search pattern.
+ *
+ * This function preprocesses the needle for the specified
+ * algorithm, so that it may later be searched for with
+ * find_compiled_pattern() as many times as needed without
+ * repeating the preprocessing step.
+ *
+ * @param[in] algorithm The algorithm to use for the search.
+ * @param[in] needle    The substring to look for.
+ *
+ * @returns Pointer to the compiled pattern, which must be
+ * released using free_search_pattern().
+ *
+ */
+search_pattern_t* compile_search_pattern(string_search_algorithm_t algorithm, const char* needle) {
+    return compile_search_pattern_n(algorithm, needle, string_length(needle));
+}
+
+/**
+ * Stop At First Match
+ *
+ * This match callback stops the search at the first match.
+ *
+ * @param[in] offset    The offset at which the match begins.
+ * @param[in] context   Unused.
+ *
+ * @returns Always returns one.
+ *
+ */
+static int stop_at_first_match(size_t offset, void* context) {
+    (void) offset;
+    (void) context;
+
+    return 1;
+}
+
+/**
+ * Match Filter
+ *
+ * This structure wraps a user-supplied match callback,
+ * discarding the matches that overlap a previous one when
+ * only non-overlapping matches were requested, and counting
+ * the matches that are passed through.
+ *
+ * @struct match_filter_t
+ *
+ */
+typedef struct {
+    /** The user-supplied callback and its context. */
+    substring_match_callback_t callback;
+    void* context;
+
+    /** Whether to report overlapping matches. */
+    substring_match_mode_t mode;
+
+    /** The length of the needle. */
+    size_t length;
+
+    /** The first offset at which a match may be reported. */
+    size_t next;
+
+    /** The number of matches reported so far. */
+    size_t count;
+} match_filter_t;
+
+/**
+ * Filter Match
+ *
+ * This match callback forwards matches to the callback
+ * wrapped by the match filter passed in as its context.
+ * Since the searching functions report matches in order of
+ * increasing offset, greedily skipping every match that
+ * begins before the end of the last reported one yields the
+ * leftmost set of non-overlapping matches.
+ *
+ * @param[in] offset    The offset at which the match begins.
+ * @param[in] context   The match filter.
+ *
+ * @returns The return value of the wrapped callback.
+ *
+ */
+static int filter_match(size_t offset, void* context) {
+    match_filter_t* filter = context;
+
+    if (offset < filter->next) {
+        return 0;
+    }
+
+    if (filter->mode == NON_OVERLAPPING_MATCHES) {
+        filter->next = offset + filter->length;
+    }
+
+    filter->count += 1;
+
+    return filter->callback(offset, filter->context);
+}
+
+/**
+ * Match Collector
+ *
+ * This structure holds the caller-supplied array in which
+ * the offsets of the matches are stored.
+ *
+ * @struct match_collector_t
+ *
+ */
+typedef struct {
+    size_t* offsets;
+    size_t capacity;
+    size_t count;
+} match_collector_t;
+
+/**
+ * Collect Match
+ *
+ * This match callback stores the offset of each match in
+ * the array held by the match collector passed in as its
+ * context, for as long as there is room left in it.
+ *
+ * @param[in] offset    The offset at which the match begins.
+ * @param[in] context   The match collector.
+ *
+ * @returns Always returns zero.
+ *
+ */
+static int collect_match(size_t offset, void* context) {
+    match_collector_t* collector = context;
+
+    if (collector->count < collector->capacity) {
+        collector->offsets[collector->count] = offset;
+    }
+
+    collector->count += 1;
+
+    return 0;
+}
+
+/**
+ * Find a compiled pattern within a length-delimited buffer.
+ *
+ * This function searches the first haystack_length bytes
+ * of the haystack for an instance of the needle the pattern
+ * was compiled from. The haystack need not be terminated,
+ * and it is scanned exactly once. No memory is allocated.
+ *
+ * @param[in] pattern           The compiled substring to look for.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ *
+ * @returns Pointer to the located string. If the substring
+ * is not found, the returned pointer is equal to NULL.
+ *
+ */
+const char* find_compiled_pattern_n(const search_pattern_t* pattern, const char* haystack, size_t haystack_length) {
+    if (pattern->length == 0) {
+        return haystack;
+    }
+
+    /**
+     * The searching functions may all assume the needle is
+     * non-empty and no longer than the haystack.
+     *
+     */
+    if (pattern->length > haystack_length) {
+        return NULL;
+    }
+
+    return pattern->search(pattern, haystack, haystack_length, stop_at_first_match, NULL);
+}
+
+/**
+ * Report every match of a compiled pattern.
+ *
+ * This function invokes the callback once for every match
+ * of the pattern within the haystack, in order of
+ * increasing offset, until either the haystack is exhausted
+ * or the callback returns a nonzero value. The haystack is
+ * scanned exactly once. An empty needle matches nowhere.
+ *
+ * @param[in] pattern           The compiled substring to look for.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ * @param[in] mode              Whether to report overlapping matches.
+ * @param[in] callback          The function to report matches to.
+ * @param[in] context           User-supplied pointer passed to the callback.
+ *
+ * @returns The number of matches reported to the callback.
+ *
+ */
+size_t for_each_compiled_pattern_n(const search_pattern_t* pattern, const char* haystack, size_t haystack_length, substring_match_mode_t mode, substring_match_callback_t callback, void* context) {
+    match_filter_t filter = {
+        .callback = callback,
+        .context = context,
+        .mode = mode,
+        .length = pattern->length,
+        .next = 0,
+        .count = 0
+    };
+
+    if ((pattern->length == 0) || (pattern->length > haystack_length)) {
+        return 0;
+    }
+
+    pattern->search(pattern, haystack, haystack_length, filter_match, &filter);
+
+    return filter.count;
+}
+
+/**
+ * Find every match of a compiled pattern.
+ *
+ * This function stores the offsets of the matches of the
+ * pattern within the haystack in the offsets array, in
+ * increasing order, until the array is full. Every match
+ * is counted, however, so a return value greater than the
+ * capacity of the array indicates that it was too small.
+ *
+ * @param[in] pattern           The compiled substring to look for.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ * @param[in] mode              Whether to report overlapping matches.
+ * @param[out] offsets          The array to store the match offsets in.
+ * @param[in] capacity          The number of elements in the offsets array.
+ *
+ * @returns The total number of matches found.
+ *
+ */
+size_t find_all_compiled_pattern_n(const search_pattern_t* pattern, const char* haystack, size_t haystack_length, substring_match_mode_t mode, size_t* offsets, size_t capacity) {
+    match_collector_t collector = {
+        .offsets = offsets,
+        .capacity = capacity,
+        .count = 0
+    };
+
+    return for_each_compiled_pattern_n(pattern, haystack, haystack_length, mode, collect_match, &collector);
+}
+
+/**
+ * Find a compiled pattern within a string.
+ *
+ * This function searches the haystack for an instance of
+ * the needle the pattern was compiled from. It performs no
+ * memory allocations.
+ *
+ * @param[in] pattern   The compiled substring to look for.
+ * @param[in] haystack  The string to look in.
+ *
+ * @returns Pointer to the located string. If the substring
+ * is not found, the returned pointer is equal to NULL.
+ *
+ */
+const char* find_compiled_pattern(const search_pattern_t* pattern, const char* haystack) {
+    return find_compiled_pattern_n(pattern, haystack, string_length(haystack));
+}
+
+/**
+ * Free a compiled search pattern.
+ *
+ * @param[in] pattern The pattern to free. May be NULL.
+ *
+ */
+void free_search_pattern(search_pattern_t* pattern) {
+    if (pattern == NULL) {
+        return;
+    }
+
+    release_search_pattern(pattern);
+    free(pattern);
+}
+
+/**
+ * Find a buffer within a buffer.
+ *
+ * This function searches the first haystack_length bytes of
+ * the haystack for an instance of the first needle_length
+ * bytes of the needle. Neither buffer need be terminated.
+ *
+ * @param[in] algorithm         The algorithm to use for the search.
+ * @param[in] needle            The substring to look for.
+ * @param[in] needle_length     The length of the needle.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ *
+ * @returns Pointer to the located string. If the substring
+ * is not found, the returned pointer is equal to NULL.
+ *
+ */
+const char* find_substring_n(string_search_algorithm_t algorithm, const char* needle, size_t needle_length, const char* haystack, size_t haystack_length) {
+    search_pattern_t pattern;
+    initialize_search_pattern(&pattern, algorithm, needle, needle_length);
+
+    const char* match = find_compiled_pattern_n(&pattern, haystack, haystack_length);
+
+    release_search_pattern(&pattern);
+
+    return match;
+}
+
+/**
+ * Report every match of a buffer within a buffer.
+ *
+ * @param[in] algorithm         The algorithm to use for the search.
+ * @param[in] needle            The substring to look for.
+ * @param[in] needle_length     The length of the needle.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ * @param[in] mode              Whether to report overlapping matches.
+ * @param[in] callback          The function to report matches to.
+ * @param[in] context           User-supplied pointer passed to the callback.
+ *
+ * @returns The number of matches reported to the callback.
+ *
+ */
+size_t for_each_substring_n(string_search_algorithm_t algorithm, const char* needle, size_t needle_length, const char* haystack, size_t haystack_length, substring_match_mode_t mode, substring_match_callback_t callback, void* context) {
+    search_pattern_t pattern;
+    initialize_search_pattern(&pattern, algorithm, needle, needle_length);
+
+    size_t count = for_each_compiled_pattern_n(&pattern, haystack, haystack_length, mode, callback, context);
+
+    release_search_pattern(&pattern);
+
+    return count;
+}
+
+/**
+ * Find every match of a buffer within a buffer.
+ *
+ * @param[in] algorithm         The algorithm to use for the search.
+ * @param[in] needle            The substring to look for.
+ * @param[in] needle_length     The length of the needle.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ * @param[in] mode              Whether to report overlapping matches.
+ * @param[out] offsets          The array to store the match offsets in.
+ * @param[in] capacity          The number of elements in the offsets array.
+ *
+ * @returns The total number of matches found.
+ *
+ */
+size_t find_all_substrings_n(string_search_algorithm_t algorithm, const char* needle, size_t needle_length, const char* haystack, size_t haystack_length, substring_match_mode_t mode, size_t* offsets, size_t capacity) {
+    match_collector_t collector = {
+        .offsets = offsets,
+        .capacity = capacity,
+        .count = 0
+    };
+
+    return for_each_substring_n(algorithm, needle, needle_length, haystack, haystack_length, mode, collect_match, &collector);
+}
+
+/**
+ * Find every match of a string within a string.
+ *
+ * @param[in] algorithm The algorithm to use for the search.
+ * @param[in] needle    The substring to look for.
+ * @param[in] haystack  The string to look in.
+ * @param[in] mode      Whether to report overlapping matches.
+ * @param[out] offsets  The array to store the match offsets in.
+ * @param[in] capacity  The number of elements in the offsets array.
+ *
+ * @returns The total number of matches found.
+ *
+ */
+size_t find_all_substrings(string_search_algorithm_t algorithm, const char* needle, const char* haystack, substring_match_mode_t mode, size_t* offsets, size_t capacity) {
+    return find_all_substrings_n(algorithm, needle, string_length(needle), haystack, string_length(haystack), mode, offsets, capacity);
 }
 
 /**
  * Find a string within a string.
  *
  * This function searches the haystack for an instance of
- * the needle.
+ * the needle. The needle is preprocessed on every call; use
+ * compile_search_pattern() when searching for the same
+ * needle repeatedly.
  *
  * @param[in] algorithm The algorithm to use for the search.
  * @param[in] needle    The substring to look for.
@@ -228,5 +1547,5 @@ string_search_function_t get_string_search_function(string_search_algorithm_t al
  *
  */
 const char* find_substring(string_search_algorithm_t algorithm, const char* needle, const char* haystack) {
-    return get_string_search_function(algorithm)(needle, haystack);
+    return find_substring_n(algorithm, needle, string_length(needle), haystack, string_length(haystack));
 }
@@ -0,0 +1,1097 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ *
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xstrings.h"
+
+#ifndef MAX
+#define MAX(a,b) ((a < b) ? (b) : (a))
+#endif
+
+#ifndef MIN
+#define MIN(a,b) ((a > b) ? (b) : (a))
+#endif
+
+/**
+ * Fuzzy Index Magic
+ *
+ * The first eight bytes of a saved fuzzy index, which also
+ * identify the version of its layout.
+ *
+ * @def FUZZY_INDEX_MAGIC
+ *
+ */
+#define FUZZY_INDEX_MAGIC "XFUZZY1"
+
+/**
+ * Fuzzy Index Grams
+ *
+ * The number of distinct bigrams, each of which is a pair
+ * of bytes. The words are padded with a zero byte at either
+ * end, so that their first and last characters take part in
+ * as many bigrams as the others.
+ *
+ * @def FUZZY_INDEX_GRAMS
+ *
+ */
+#define FUZZY_INDEX_GRAMS 65536
+
+/**
+ * Fuzzy Index No Node
+ *
+ * @def FUZZY_INDEX_NO_NODE
+ *
+ */
+#define FUZZY_INDEX_NO_NODE UINT32_MAX
+
+/**
+ * Fuzzy Index Align
+ *
+ * Every array of the index starts on an eight byte boundary
+ * of its block, so that a mapped file can be used in place.
+ *
+ * @def FUZZY_INDEX_ALIGN
+ *
+ */
+#define FUZZY_INDEX_ALIGN(size) (((size) + 7) & ~((size_t) 7))
+
+/**
+ * Fuzzy Index Header
+ *
+ * The header at the start of the block of an index, giving
+ * the sizes of the arrays that follow it.
+ *
+ */
+typedef struct {
+    char magic[8];
+    uint64_t count;
+    uint64_t text_size;
+    uint64_t child_count;
+    uint64_t posting_count;
+} fuzzy_index_header_t;
+
+/**
+ * Fuzzy Index
+ *
+ * The block of an index holds, after its header:
+ *
+ * - word_offsets: the offset in text of each word, and of
+ *   the end of the text. Every word is null-terminated.
+ * - child_offsets: the offset in child_nodes of the first
+ *   child of each node of the BK-tree, whose root is the
+ *   first word, and of the end of the array.
+ * - gram_offsets: the offset in the postings of the first
+ *   word containing each bigram, and of the end of them.
+ * - child_nodes and child_distances: the children of each
+ *   node, in increasing order of their distance to it.
+ * - posting_words and posting_counts: the words containing
+ *   each bigram, in increasing order, and the number of
+ *   times they contain it.
+ * - text: the words themselves.
+ *
+ */
+struct fuzzy_index {
+    void* base;
+    size_t size;
+    int mapped;
+    fuzzy_index_header_t* header;
+    uint64_t* word_offsets;
+    uint64_t* child_offsets;
+    uint64_t* gram_offsets;
+    uint32_t* child_nodes;
+    uint32_t* child_distances;
+    uint32_t* posting_words;
+    uint32_t* posting_counts;
+    char* text;
+};
+
+/**
+ * Fuzzy Index Workspace
+ *
+ * The scratch memory of the queries: the edit distance
+ * workspace, the stack of the BK-tree walk, the bigrams of
+ * the term, and, for the bigram filter, a counter of shared
+ * bigrams for every word along with the list of the words
+ * whose counters a query has touched. The counters are
+ * zero between queries, since each query resets only those
+ * it touched, so that a query costs nothing in proportion
+ * to the size of the vocabulary.
+ *
+ */
+struct fuzzy_index_workspace {
+    edit_distance_workspace_t* distances;
+    uint32_t* stack;
+    size_t stack_capacity;
+    uint16_t* grams;
+    uint32_t* gram_counts;
+    size_t gram_capacity;
+    uint32_t* shared;
+    uint32_t* candidates;
+    size_t word_capacity;
+};
+
+/**
+ * Layout Fuzzy Index
+ *
+ * This function computes the size of the block of an index
+ * with the given header, and, if a block is given, points
+ * the arrays of the index into it.
+ *
+ * @param[out] index The index whose arrays to set, if base is not NULL.
+ * @param[in] base The block of the index, or NULL.
+ * @param[in] header The header giving the sizes of the arrays.
+ *
+ * @returns The size of the block, in bytes.
+ *
+ */
+static size_t layout_fuzzy_index(fuzzy_index_t* index, char* base, const fuzzy_index_header_t* header) {
+    const size_t count = (size_t) header->count;
+
+    size_t offset = FUZZY_INDEX_ALIGN(sizeof (fuzzy_index_header_t));
+
+    const size_t word_offsets = offset;
+    offset += sizeof (uint64_t) * (count + 1);
+
+    const size_t child_offsets = offset;
+    offset += sizeof (uint64_t) * (count + 1);
+
+    const size_t gram_offsets = offset;
+    offset += sizeof (uint64_t) * (FUZZY_INDEX_GRAMS + 1);
+
+    const size_t child_nodes = offset;
+    offset += FUZZY_INDEX_ALIGN(sizeof (uint32_t) * (size_t) header->child_count);
+
+    const size_t child_distances = offset;
+    offset += FUZZY_INDEX_ALIGN(sizeof (uint32_t) * (size_t) header->child_count);
+
+    const size_t posting_words = offset;
+    offset += FUZZY_INDEX_ALIGN(sizeof (uint32_t) * (size_t) header->posting_count);
+
+    const size_t posting_counts = offset;
+    offset += FUZZY_INDEX_ALIGN(sizeof (uint32_t) * (size_t) header->posting_count);
+
+    const size_t text = offset;
+    offset += FUZZY_INDEX_ALIGN((size_t) header->text_size);
+
+    if (base != NULL) {
+        index->base = base;
+        index->size = offset;
+        index->header = (fuzzy_index_header_t*) base;
+        index->word_offsets = (uint64_t*) (base + word_offsets);
+        index->child_offsets = (uint64_t*) (base + child_offsets);
+        index->gram_offsets = (uint64_t*) (base + gram_offsets);
+        index->child_nodes = (uint32_t*) (base + child_nodes);
+        index->child_distances = (uint32_t*) (base + child_distances);
+        index->posting_words = (uint32_t*) (base + posting_words);
+        index->posting_counts = (uint32_t*) (base + posting_counts);
+        index->text = base + text;
+    }
+
+    return offset;
+}
+
+/**
+ * Compare Bigrams
+ *
+ */
+static int compare_bigrams(const void* a, const void* b) {
+    const uint16_t x = *(const uint16_t*) a;
+    const uint16_t y = *(const uint16_t*) b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * Collect Distinct Bigrams
+ *
+ * This function lists the distinct bigrams of a padded
+ * word, and the number of times each of them occurs in it.
+ *
+ * @param[in] word The word whose bigrams to collect.
+ * @param[in] length The length of the word.
+ * @param[out] grams The distinct bigrams, of length + 1 entries.
+ * @param[out] counts Their numbers of occurrences, of length + 1 entries.
+ *
+ * @returns The number of distinct bigrams.
+ *
+ */
+static size_t collect_distinct_bigrams(const char* word, size_t length, uint16_t* grams, uint32_t* counts) {
+    unsigned int previous = 0;
+
+    for (size_t i = 0; i < length; ++i) {
+        grams[i] = (uint16_t) ((previous << 8) | (unsigned char) word[i]);
+        previous = (unsigned char) word[i];
+    }
+
+    grams[length] = (uint16_t) (previous << 8);
+
+    qsort(grams, length + 1, sizeof (uint16_t), compare_bigrams);
+
+    size_t distinct = 0;
+
+    for (size_t i = 0; i <= length; ++i) {
+        if ((distinct > 0) && (grams[distinct - 1] == grams[i])) {
+            ++counts[distinct - 1];
+            continue;
+        }
+
+        grams[distinct] = grams[i];
+        counts[distinct] = 1;
+        ++distinct;
+    }
+
+    return distinct;
+}
+
+/**
+ * Get Fuzzy Index Word Length
+ *
+ */
+static inline size_t get_fuzzy_index_word_length(const fuzzy_index_t* index, size_t word_index) {
+    return (size_t) (index->word_offsets[word_index + 1] - index->word_offsets[word_index] - 1);
+}
+
+/**
+ * Build Fuzzy Index Tree
+ *
+ * This function builds the BK-tree of the index. Each word
+ * after the first descends from the root, following at
+ * every node the child edge labelled with its distance to
+ * that node, until there is no such edge, where it is added
+ * as a new child. The tree is built with linked lists of
+ * children and then flattened, sorting the children of each
+ * node by distance.
+ *
+ * @param[in,out] index The index, whose words are already stored.
+ *
+ * @cite burkhard_approaches_1973
+ *
+ */
+static void build_fuzzy_index_tree(fuzzy_index_t* index) {
+    const size_t count = (size_t) index->header->count;
+
+    if (count == 0) {
+        return;
+    }
+
+    uint32_t* first_child = malloc(sizeof (uint32_t) * count);
+    uint32_t* next_sibling = malloc(sizeof (uint32_t) * count);
+    uint32_t* edge = malloc(sizeof (uint32_t) * count);
+
+    if ((first_child == NULL) || (next_sibling == NULL) || (edge == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        first_child[i] = FUZZY_INDEX_NO_NODE;
+        next_sibling[i] = FUZZY_INDEX_NO_NODE;
+    }
+
+    edit_distance_workspace_t* workspace = create_edit_distance_workspace(0);
+
+    for (size_t i = 1; i < count; ++i) {
+        const char* word = index->text + index->word_offsets[i];
+        const size_t length = get_fuzzy_index_word_length(index, i);
+
+        size_t node = 0;
+
+        for (;;) {
+            const size_t distance = calculate_edit_distance_workspace_n(workspace, LEVENSHTEIN_DISTANCE, word, length, index->text + index->word_offsets[node], get_fuzzy_index_word_length(index, node));
+
+            uint32_t child = first_child[node];
+
+            while ((child != FUZZY_INDEX_NO_NODE) && (edge[child] != distance)) {
+                child = next_sibling[child];
+            }
+
+            if (child == FUZZY_INDEX_NO_NODE) {
+                edge[i] = (uint32_t) distance;
+                next_sibling[i] = first_child[node];
+                first_child[node] = (uint32_t) i;
+                index->child_offsets[node + 1] += 1;
+                break;
+            }
+
+            node = child;
+        }
+    }
+
+    free_edit_distance_workspace(workspace);
+
+    for (size_t node = 0; node < count; ++node) {
+        index->child_offsets[node + 1] += index->child_offsets[node];
+    }
+
+    for (size_t node = 0; node < count; ++node) {
+        uint32_t* nodes = index->child_nodes + index->child_offsets[node];
+        uint32_t* distances = index->child_distances + index->child_offsets[node];
+
+        size_t children = 0;
+
+        for (uint32_t child = first_child[node]; child != FUZZY_INDEX_NO_NODE; child = next_sibling[child]) {
+            size_t position = children++;
+
+            while ((position > 0) && (distances[position - 1] > edge[child])) {
+                nodes[position] = nodes[position - 1];
+                distances[position] = distances[position - 1];
+                --position;
+            }
+
+            nodes[position] = child;
+            distances[position] = edge[child];
+        }
+    }
+
+    free(first_child);
+    free(next_sibling);
+    free(edge);
+}
+
+/**
+ * Build a fuzzy index over an array of buffers.
+ *
+ * The vocabulary is first measured, and its bigrams
+ * counted, to size the block of the index. The words are
+ * then copied into it, the postings of each bigram filled
+ * in, and the BK-tree built over the copied words.
+ *
+ * @param[in] words The vocabulary to index.
+ * @param[in] lengths The lengths of the words, or NULL if they are strings.
+ * @param[in] count The number of words.
+ *
+ * @returns A new fuzzy index, or NULL if there are too many
+ * words to index.
+ *
+ */
+fuzzy_index_t* build_fuzzy_index_n(const char* const* words, const size_t* lengths, size_t count) {
+    if (count >= FUZZY_INDEX_NO_NODE) {
+        fprintf(stderr, "[Error] %s\n", "Too many words for a fuzzy index");
+        return NULL;
+    }
+
+    fuzzy_index_header_t header;
+
+    memset(&header, 0, sizeof (header));
+    memcpy(header.magic, FUZZY_INDEX_MAGIC, sizeof (header.magic));
+
+    header.count = count;
+    header.child_count = (count > 0) ? count - 1 : 0;
+
+    size_t* word_lengths = malloc(sizeof (size_t) * (count + 1));
+    uint64_t* gram_counts = calloc(FUZZY_INDEX_GRAMS, sizeof (uint64_t));
+
+    if ((word_lengths == NULL) || (gram_counts == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t longest = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        word_lengths[i] = (lengths != NULL) ? lengths[i] : string_length(words[i]);
+        longest = MAX(longest, word_lengths[i]);
+        header.text_size += word_lengths[i] + 1;
+    }
+
+    uint16_t* grams = malloc(sizeof (uint16_t) * (longest + 1));
+    uint32_t* counts = malloc(sizeof (uint32_t) * (longest + 1));
+
+    if ((grams == NULL) || (counts == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t distinct = collect_distinct_bigrams(words[i], word_lengths[i], grams, counts);
+
+        for (size_t g = 0; g < distinct; ++g) {
+            ++gram_counts[grams[g]];
+        }
+
+        header.posting_count += distinct;
+    }
+
+    fuzzy_index_t* index = malloc(sizeof (fuzzy_index_t));
+    char* base = calloc(1, layout_fuzzy_index(NULL, NULL, &header));
+
+    if ((index == NULL) || (base == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    layout_fuzzy_index(index, base, &header);
+
+    index->mapped = 0;
+
+    memcpy(index->header, &header, sizeof (header));
+
+    for (size_t i = 0; i < count; ++i) {
+        index->word_offsets[i + 1] = index->word_offsets[i] + word_lengths[i] + 1;
+        memcpy(index->text + index->word_offsets[i], words[i], word_lengths[i]);
+    }
+
+    for (size_t g = 0; g < FUZZY_INDEX_GRAMS; ++g) {
+        index->gram_offsets[g + 1] = index->gram_offsets[g] + gram_counts[g];
+
+        /** Reuse the counts as the next free posting of each bigram. */
+        gram_counts[g] = index->gram_offsets[g];
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t distinct = collect_distinct_bigrams(words[i], word_lengths[i], grams, counts);
+
+        for (size_t g = 0; g < distinct; ++g) {
+            const uint64_t posting = gram_counts[grams[g]]++;
+
+            index->posting_words[posting] = (uint32_t) i;
+            index->posting_counts[posting] = counts[g];
+        }
+    }
+
+    free(grams);
+    free(counts);
+    free(gram_counts);
+    free(word_lengths);
+
+    build_fuzzy_index_tree(index);
+
+    return index;
+}
+
+/**
+ * Build a fuzzy index over an array of strings.
+ *
+ * @param[in] words The vocabulary to index.
+ * @param[in] count The number of words.
+ *
+ * @returns A new fuzzy index.
+ *
+ */
+fuzzy_index_t* build_fuzzy_index(const char* const* words, size_t count) {
+    return build_fuzzy_index_n(words, NULL, count);
+}
+
+/**
+ * Query Fuzzy Index Tree
+ *
+ * This function walks the BK-tree from its root. By the
+ * triangle inequality, if the term is at distance d from a
+ * node, the words within distance k of the term can only
+ * lie under the children at distance d - k to d + k from
+ * that node, so the subtrees under every other child are
+ * skipped.
+ *
+ * @param[in] index The index to query.
+ * @param[in,out] workspace The scratch memory of the query.
+ * @param[in] term The term to look for.
+ * @param[in] m The length of the term.
+ * @param[in] k The largest distance of interest.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns The number of words reported.
+ *
+ */
+static size_t query_fuzzy_index_tree(const fuzzy_index_t* index, fuzzy_index_workspace_t* workspace, const char* term, size_t m, size_t k, fuzzy_match_callback_t callback, void* context) {
+    size_t depth = 0;
+    uint32_t* stack = workspace->stack;
+
+    stack[depth++] = 0;
+
+    size_t reported = 0;
+
+    while (depth > 0) {
+        const uint32_t node = stack[--depth];
+
+        const size_t distance = calculate_edit_distance_workspace_n(workspace->distances, LEVENSHTEIN_DISTANCE, term, m, index->text + index->word_offsets[node], get_fuzzy_index_word_length(index, node));
+
+        if (distance <= k) {
+            ++reported;
+
+            if (callback(node, distance, context) != 0) {
+                break;
+            }
+        }
+
+        const size_t low = (distance > k) ? distance - k : 0;
+        const size_t high = (distance > SIZE_MAX - k) ? SIZE_MAX : distance + k;
+
+        for (uint64_t c = index->child_offsets[node]; c < index->child_offsets[node + 1]; ++c) {
+            if (index->child_distances[c] < low) {
+                continue;
+            }
+
+            if (index->child_distances[c] > high) {
+                break;
+            }
+
+            if (depth == workspace->stack_capacity) {
+                workspace->stack_capacity *= 2;
+                workspace->stack = realloc(workspace->stack, sizeof (uint32_t) * workspace->stack_capacity);
+
+                if (workspace->stack == NULL) {
+                    fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+                    exit(EXIT_FAILURE);
+                }
+
+                stack = workspace->stack;
+            }
+
+            stack[depth++] = index->child_nodes[c];
+        }
+    }
+
+    return reported;
+}
+
+/**
+ * Query Fuzzy Index Bigrams
+ *
+ * This function implements the q-gram count filter. Each
+ * edit operation destroys at most two of the bigrams of a
+ * padded word, so a word of length n within distance k of a
+ * term of length m shares at least max(m, n) + 1 - 2k
+ * bigrams with it, counting repeated bigrams as many times
+ * as both contain them. The postings of the term's bigrams
+ * are merged into a count of the bigrams shared by every
+ * word, and only the words passing both this filter and
+ * the length filter are compared to the term. The filter is
+ * only used when it can reject some word, that is, when
+ * 2k <= m.
+ *
+ * @param[in] index The index to query.
+ * @param[in,out] workspace The scratch memory of the query.
+ * @param[in] term The term to look for.
+ * @param[in] m The length of the term.
+ * @param[in] k The largest distance of interest, at most m / 2.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns The number of words reported.
+ *
+ * @cite ukkonen_approximate_1992
+ *
+ */
+static size_t query_fuzzy_index_bigrams(const fuzzy_index_t* index, fuzzy_index_workspace_t* workspace, const char* term, size_t m, size_t k, fuzzy_match_callback_t callback, void* context) {
+    uint16_t* grams = workspace->grams;
+    uint32_t* counts = workspace->gram_counts;
+    uint32_t* shared = workspace->shared;
+    uint32_t* candidates = workspace->candidates;
+
+    size_t touched = 0;
+
+    const size_t distinct = collect_distinct_bigrams(term, m, grams, counts);
+
+    for (size_t g = 0; g < distinct; ++g) {
+        for (uint64_t p = index->gram_offsets[grams[g]]; p < index->gram_offsets[grams[g] + 1]; ++p) {
+            const uint32_t word = index->posting_words[p];
+
+            /**
+             * The postings of a bigram hold every word at most once,
+             * and both counts are positive, so each word is listed
+             * once and the list never outgrows the vocabulary.
+             *
+             */
+            if (shared[word] == 0) {
+                candidates[touched++] = word;
+            }
+
+            shared[word] += MIN(counts[g], index->posting_counts[p]);
+        }
+    }
+
+    size_t reported = 0;
+
+    size_t i = 0;
+
+    for (; i < touched; ++i) {
+        const uint32_t word = candidates[i];
+        const size_t n = get_fuzzy_index_word_length(index, word);
+
+        const uint32_t common = shared[word];
+
+        shared[word] = 0;
+
+        if (((n > m) ? n - m : m - n) > k) {
+            continue;
+        }
+
+        if (common + (2 * k) < MAX(m, n) + 1) {
+            continue;
+        }
+
+        const size_t distance = calculate_edit_distance_bounded_workspace_n(workspace->distances, LEVENSHTEIN_DISTANCE, term, m, index->text + index->word_offsets[word], n, k);
+
+        if (distance == EDIT_DISTANCE_EXCEEDED) {
+            continue;
+        }
+
+        ++reported;
+
+        if (callback(word, distance, context) != 0) {
+            ++i;
+            break;
+        }
+    }
+
+    /**
+     * Leave the counters zero for the next query, even when
+     * the callback stopped this one early.
+     *
+     */
+    for (; i < touched; ++i) {
+        shared[candidates[i]] = 0;
+    }
+
+    return reported;
+}
+
+/**
+ * Reserve Fuzzy Index Workspace
+ *
+ * This function grows the workspace, if need be, to query
+ * the given index for a term of the given length. Newly
+ * allocated counters are cleared; the others already are.
+ *
+ * @param[in,out] workspace The workspace to grow.
+ * @param[in] index The index about to be queried.
+ * @param[in] m The length of the term.
+ *
+ */
+static void reserve_fuzzy_index_workspace(fuzzy_index_workspace_t* workspace, const fuzzy_index_t* index, size_t m) {
+    const size_t count = (size_t) index->header->count;
+
+    if (m + 1 > workspace->gram_capacity) {
+        workspace->gram_capacity = MAX(m + 1, 2 * workspace->gram_capacity);
+        workspace->grams = realloc(workspace->grams, sizeof (uint16_t) * workspace->gram_capacity);
+        workspace->gram_counts = realloc(workspace->gram_counts, sizeof (uint32_t) * workspace->gram_capacity);
+
+        if ((workspace->grams == NULL) || (workspace->gram_counts == NULL)) {
+            fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (count > workspace->word_capacity) {
+        workspace->shared = realloc(workspace->shared, sizeof (uint32_t) * count);
+        workspace->candidates = realloc(workspace->candidates, sizeof (uint32_t) * count);
+
+        if ((workspace->shared == NULL) || (workspace->candidates == NULL)) {
+            fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+            exit(EXIT_FAILURE);
+        }
+
+        memset(workspace->shared + workspace->word_capacity, 0, sizeof (uint32_t) * (count - workspace->word_capacity));
+
+        workspace->word_capacity = count;
+    }
+}
+
+/**
+ * Create a fuzzy index workspace.
+ *
+ * @returns A new, empty workspace.
+ *
+ */
+fuzzy_index_workspace_t* create_fuzzy_index_workspace(void) {
+    fuzzy_index_workspace_t* workspace = calloc(1, sizeof (fuzzy_index_workspace_t));
+
+    if (workspace == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    workspace->distances = create_edit_distance_workspace(0);
+    workspace->stack_capacity = 64;
+    workspace->stack = malloc(sizeof (uint32_t) * workspace->stack_capacity);
+
+    if (workspace->stack == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    return workspace;
+}
+
+/**
+ * Find the words of a fuzzy index near a buffer, using the
+ * given workspace for scratch memory.
+ *
+ * The bigram filter is used whenever it applies, since it
+ * prunes far more words than the BK-tree for small
+ * distances, and the BK-tree otherwise.
+ *
+ * @param[in,out] workspace The workspace to use.
+ * @param[in] index The index to query.
+ * @param[in] term The term to look for.
+ * @param[in] term_length The length of the term.
+ * @param[in] max_distance The largest distance of interest.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns The number of words reported.
+ *
+ */
+size_t query_fuzzy_index_workspace_n(fuzzy_index_workspace_t* workspace, const fuzzy_index_t* index, const char* term, size_t term_length, size_t max_distance, fuzzy_match_callback_t callback, void* context) {
+    if (index->header->count == 0) {
+        return 0;
+    }
+
+    if (max_distance <= term_length / 2) {
+        reserve_fuzzy_index_workspace(workspace, index, term_length);
+
+        return query_fuzzy_index_bigrams(index, workspace, term, term_length, max_distance, callback, context);
+    }
+
+    return query_fuzzy_index_tree(index, workspace, term, term_length, max_distance, callback, context);
+}
+
+/**
+ * Release a fuzzy index workspace.
+ *
+ * @param[in] workspace The workspace to release.
+ *
+ */
+void free_fuzzy_index_workspace(fuzzy_index_workspace_t* workspace) {
+    if (workspace == NULL) {
+        return;
+    }
+
+    free_edit_distance_workspace(workspace->distances);
+    free(workspace->stack);
+    free(workspace->grams);
+    free(workspace->gram_counts);
+    free(workspace->shared);
+    free(workspace->candidates);
+    free(workspace);
+}
+
+/**
+ * Find the words of a fuzzy index near a buffer.
+ *
+ * @param[in] index The index to query.
+ * @param[in] term The term to look for.
+ * @param[in] term_length The length of the term.
+ * @param[in] max_distance The largest distance of interest.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns The number of words reported.
+ *
+ */
+size_t query_fuzzy_index_n(const fuzzy_index_t* index, const char* term, size_t term_length, size_t max_distance, fuzzy_match_callback_t callback, void* context) {
+    fuzzy_index_workspace_t* workspace = create_fuzzy_index_workspace();
+
+    const size_t reported = query_fuzzy_index_workspace_n(workspace, index, term, term_length, max_distance, callback, context);
+
+    free_fuzzy_index_workspace(workspace);
+
+    return reported;
+}
+
+/**
+ * Find the words of a fuzzy index near a term.
+ *
+ * @param[in] index The index to query.
+ * @param[in] term The term to look for.
+ * @param[in] max_distance The largest distance of interest.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns The number of words reported.
+ *
+ */
+size_t query_fuzzy_index(const fuzzy_index_t* index, const char* term, size_t max_distance, fuzzy_match_callback_t callback, void* context) {
+    return query_fuzzy_index_n(index, term, string_length(term), max_distance, callback, context);
+}
+
+/**
+ * Get the number of words in a fuzzy index.
+ *
+ * @param[in] index The index to measure.
+ *
+ * @returns The number of words in the index.
+ *
+ */
+size_t get_fuzzy_index_size(const fuzzy_index_t* index) {
+    return (size_t) index->header->count;
+}
+
+/**
+ * Get a word of a fuzzy index.
+ *
+ * @param[in] index The index holding the word.
+ * @param[in] word_index The index of the word in the vocabulary.
+ *
+ * @returns The word, as a null-terminated string owned by
+ * the index.
+ *
+ */
+const char* get_fuzzy_index_word(const fuzzy_index_t* index, size_t word_index) {
+    return index->text + index->word_offsets[word_index];
+}
+
+/**
+ * Save a fuzzy index to a file.
+ *
+ * The block of the index is written out as it is.
+ *
+ * @param[in] index The index to save.
+ * @param[in] path The path of the file to write.
+ *
+ * @returns Zero on success, or -1 if the file could not be
+ * written.
+ *
+ */
+int save_fuzzy_index(const fuzzy_index_t* index, const char* path) {
+    FILE* file = fopen(path, "wb");
+
+    if (file == NULL) {
+        return -1;
+    }
+
+    const size_t written = fwrite(index->base, 1, index->size, file);
+
+    if ((fclose(file) != 0) || (written != index->size)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Validate Fuzzy Index
+ *
+ * This function checks the arrays of an index whose layout
+ * matches its header, so that a corrupt file cannot make
+ * a query read outside of the block or walk forever:
+ *
+ * - every offset array starts at zero, never decreases, and
+ *   ends at the size of the array it indexes;
+ * - every word is null-terminated within the text;
+ * - every child of a node comes after it, and every word
+ *   but the root is the child of exactly one node, so that
+ *   the BK-tree is a tree, and its children are sorted by
+ *   distance;
+ * - the postings of every bigram are word indices in
+ *   increasing order, with positive counts.
+ *
+ * @param[in] index The index to validate.
+ *
+ * @returns Nonzero if the index is valid.
+ *
+ */
+static int validate_fuzzy_index(const fuzzy_index_t* index) {
+    const fuzzy_index_header_t* header = index->header;
+
+    const size_t count = (size_t) header->count;
+
+    if ((index->word_offsets[0] != 0) || (index->word_offsets[count] != header->text_size)) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t end = index->word_offsets[i + 1];
+
+        if ((end <= index->word_offsets[i]) || (end > header->text_size) || (index->text[end - 1] != '\0')) {
+            return 0;
+        }
+    }
+
+    if ((index->child_offsets[0] != 0) || (index->child_offsets[count] != header->child_count)) {
+        return 0;
+    }
+
+    unsigned char* parented = calloc(count + 1, sizeof (unsigned char));
+
+    if (parented == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    int valid = 1;
+
+    for (size_t node = 0; valid && (node < count); ++node) {
+        const uint64_t begin = index->child_offsets[node];
+        const uint64_t end = index->child_offsets[node + 1];
+
+        if ((end < begin) || (end > header->child_count)) {
+            valid = 0;
+            break;
+        }
+
+        for (uint64_t c = begin; c < end; ++c) {
+            const uint32_t child = index->child_nodes[c];
+
+            if ((child <= node) || (child >= count) || parented[child]) {
+                valid = 0;
+                break;
+            }
+
+            if ((c > begin) && (index->child_distances[c] < index->child_distances[c - 1])) {
+                valid = 0;
+                break;
+            }
+
+            parented[child] = 1;
+        }
+    }
+
+    free(parented);
+
+    if (!valid) {
+        return 0;
+    }
+
+    if ((index->gram_offsets[0] != 0) || (index->gram_offsets[FUZZY_INDEX_GRAMS] != header->posting_count)) {
+        return 0;
+    }
+
+    for (size_t g = 0; g < FUZZY_INDEX_GRAMS; ++g) {
+        const uint64_t begin = index->gram_offsets[g];
+        const uint64_t end = index->gram_offsets[g + 1];
+
+        if ((end < begin) || (end > header->posting_count)) {
+            return 0;
+        }
+
+        for (uint64_t p = begin; p < end; ++p) {
+            if ((index->posting_words[p] >= count) || (index->posting_counts[p] == 0)) {
+                return 0;
+            }
+
+            if ((p > begin) && (index->posting_words[p] <= index->posting_words[p - 1])) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Load a fuzzy index saved by save_fuzzy_index().
+ *
+ * The header of the file is checked against the magic
+ * number, and the sizes it gives against the size of the
+ * file, before the arrays of the index are pointed into
+ * the mapping. The contents of the arrays are then checked
+ * with validate_fuzzy_index(), so that the queries can
+ * trust them as they trust those of a built index.
+ *
+ * @param[in] path The path of the file to load.
+ *
+ * @returns The loaded index, or NULL if the file could not
+ * be mapped or does not hold a valid index.
+ *
+ */
+fuzzy_index_t* load_fuzzy_index(const char* path) {
+    const int descriptor = open(path, O_RDONLY);
+
+    if (descriptor < 0) {
+        return NULL;
+    }
+
+    struct stat status;
+
+    if ((fstat(descriptor, &status) != 0) || ((size_t) status.st_size < sizeof (fuzzy_index_header_t))) {
+        close(descriptor);
+        return NULL;
+    }
+
+    const size_t size = (size_t) status.st_size;
+
+    void* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    close(descriptor);
+
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    const fuzzy_index_header_t* header = base;
+
+    /**
+     * Bounding every count by the size of the file before
+     * computing the layout keeps its arithmetic from
+     * overflowing on a corrupt header.
+     *
+     */
+    const int valid = (memcmp(header->magic, FUZZY_INDEX_MAGIC, sizeof (header->magic)) == 0)
+        && (header->count < FUZZY_INDEX_NO_NODE)
+        && (header->child_count == ((header->count > 0) ? header->count - 1 : 0))
+        && (header->text_size <= size)
+        && (header->posting_count <= size)
+        && (layout_fuzzy_index(NULL, NULL, header) == size);
+
+    fuzzy_index_t* index = valid ? malloc(sizeof (fuzzy_index_t)) : NULL;
+
+    if (index == NULL) {
+        munmap(base, size);
+        return NULL;
+    }
+
+    layout_fuzzy_index(index, base, header);
+
+    index->mapped = 1;
+
+    if (!validate_fuzzy_index(index)) {
+        free_fuzzy_index(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+/**
+ * Release a fuzzy index.
+ *
+ * @param[in] index The index to release.
+ *
+ */
+void free_fuzzy_index(fuzzy_index_t* index) {
+    if (index == NULL) {
+        return;
+    }
+
+    if (index->mapped) {
+        munmap(index->base, index->size);
+    } else {
+        free(index->base);
+    }
+
+    free(index);
+}
@@ -0,0 +1,402 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ * 
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ * 
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xstrings.h"
+
+/**
+ * Pattern Set Hash Table Slot
+ *
+ * Each slot of the open-addressing hash table of a
+ * Rabin-Karp pattern set holds the hash of one needle,
+ * together with its index in the set. Needles with equal
+ * hashes occupy consecutive slots, as collisions are
+ * resolved by linear probing.
+ *
+ * @struct pattern_set_slot_t
+ *
+ */
+typedef struct {
+    size_t hash;
+    size_t index;
+} pattern_set_slot_t;
+
+/**
+ * Empty Pattern Set Slot
+ *
+ * This value marks slots of the hash table not occupied by
+ * any needle.
+ *
+ * @def PATTERN_SET_EMPTY_SLOT
+ *
+ */
+#define PATTERN_SET_EMPTY_SLOT ((size_t) -1)
+
+/**
+ * Compiled Pattern Set
+ *
+ * @struct search_pattern_set
+ *
+ */
+struct search_pattern_set {
+    /** The algorithm the set was compiled for. */
+    string_search_algorithm_t algorithm;
+
+    /** The number of needles in the set. */
+    size_t count;
+
+    /** Copies of the needles, and their lengths. */
+    const char** needles;
+    size_t* lengths;
+
+    /** The buffer holding the copies of the needles. */
+    char* buffer;
+
+    /** The common length of every needle. */
+    size_t length;
+
+    /** Weight of the leading character in the Rabin-Karp hash. */
+    size_t high_order;
+
+    /** Number of bits in the index of a hash table slot. */
+    size_t table_bits;
+
+    /** The open-addressing table of needle hashes. */
+    pattern_set_slot_t* table;
+
+    /** The Aho-Corasick automaton for the needles. */
+    aho_corasick_automaton_t* automaton;
+};
+
+/**
+ * Allocate memory for a pattern set, exiting the program
+ * if the allocation fails.
+ *
+ * @param[in] size The number of bytes to allocate.
+ *
+ * @returns Pointer to the allocated memory.
+ *
+ */
+static void* allocate_pattern_set_memory(size_t size) {
+    void* memory = malloc(size);
+
+    if (memory == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    return memory;
+}
+
+/**
+ * Pattern Set Hash Table Slot Index
+ *
+ * The low-order bits of a Rabin-Karp hash depend only on
+ * the low-order bits of the characters hashed, so the hash
+ * is scrambled with a Fibonacci multiplicative hash, and
+ * the slot index taken from its high-order bits instead.
+ *
+ * @param[in] set The pattern set.
+ * @param[in] hash The Rabin-Karp hash to look up.
+ *
+ * @returns The index of the first slot to probe.
+ *
+ */
+static inline size_t pattern_set_slot(const search_pattern_set_t* set, size_t hash) {
+    return (hash * (size_t) 0x9E3779B97F4A7C15ULL) >> ((sizeof (size_t) * CHAR_BIT) - set->table_bits);
+}
+
+/**
+ * Build Rabin-Karp Pattern Set
+ *
+ * This function verifies that every needle in the set has
+ * the same, nonzero length, and it inserts the hash of each
+ * of them into a table with at least twice as many slots as
+ * there are needles, to keep the probe sequences short.
+ *
+ * @param[in] set The pattern set, with its needles already copied.
+ *
+ * @returns Zero on success, or nonzero if the needles are
+ * not all of the same nonzero length.
+ *
+ */
+static int build_rabin_karp_pattern_set(search_pattern_set_t* set) {
+    set->length = (set->count > 0) ? set->lengths[0] : 0;
+
+    for (size_t i = 0; i < set->count; ++i) {
+        if ((set->lengths[i] != set->length) || (set->lengths[i] == 0)) {
+            fprintf(stderr, "[Error] %s\n", "Rabin-Karp pattern sets require needles of equal, nonzero length");
+            return 1;
+        }
+    }
+
+    set->high_order = rabin_karp_high_order(set->length);
+    set->table_bits = 1;
+
+    while (((size_t) 1 << set->table_bits) < (2 * set->count)) {
+        set->table_bits += 1;
+    }
+
+    const size_t slots = (size_t) 1 << set->table_bits;
+
+    set->table = allocate_pattern_set_memory(sizeof (pattern_set_slot_t) * slots);
+
+    for (size_t i = 0; i < slots; ++i) {
+        set->table[i].hash = 0;
+        set->table[i].index = PATTERN_SET_EMPTY_SLOT;
+    }
+
+    for (size_t i = 0; i < set->count; ++i) {
+        const size_t hash = rabin_karp_hash(set->needles[i], set->length);
+        size_t slot = pattern_set_slot(set, hash);
+
+        while (set->table[slot].index != PATTERN_SET_EMPTY_SLOT) {
+            slot = (slot + 1) & (slots - 1);
+        }
+
+        set->table[slot].hash = hash;
+        set->table[slot].index = i;
+    }
+
+    return 0;
+}
+
+/**
+ * Rabin-Karp Pattern Set Search
+ *
+ * This function slides a window the common length of the
+ * needles across the haystack, maintaining its rolling
+ * hash. At each position, the hash is looked up in the
+ * table of needle hashes, and only the needles whose hash
+ * matches are compared character by character, so the cost
+ * per position is independent of the number of needles.
+ *
+ * @param[in] set The compiled pattern set.
+ * @param[in] haystack The text to look for the needles in.
+ * @param[in] h The length of the haystack.
+ * @param[in] callback The function to report matches to.
+ * @param[in] context User-supplied pointer passed to the callback.
+ *
+ * @returns The number of matches reported to the callback.
+ *
+ * @cite cormen_introduction_2009
+ *
+ */
+static size_t rabin_karp_pattern_set_search(const search_pattern_set_t* set, const char* haystack, size_t h, pattern_set_match_callback_t callback, void* context) {
+    const size_t m = set->length;
+    const size_t mask = ((size_t) 1 << set->table_bits) - 1;
+    const pattern_set_slot_t* table = set->table;
+
+    size_t matches = 0;
+
+    if ((set->count == 0) || (m > h)) {
+        return matches;
+    }
+
+    size_t hash = rabin_karp_hash(haystack, m);
+
+    for (size_t i = 0; ; ++i) {
+        for (size_t slot = pattern_set_slot(set, hash); table[slot].index != PATTERN_SET_EMPTY_SLOT; slot = (slot + 1) & mask) {
+            if ((table[slot].hash == hash) && (memcmp(haystack + i, set->needles[table[slot].index], m) == 0)) {
+                matches += 1;
+
+                if (callback(table[slot].index, i, context) != 0) {
+                    return matches;
+                }
+            }
+        }
+
+        if (i + m >= h) {
+            break;
+        }
+
+        hash = rabin_karp_roll(hash, haystack[i], haystack[i + m], set->high_order);
+    }
+
+    return matches;
+}
+
+/**
+ * Compile a set of length-delimited search patterns.
+ *
+ * @param[in] algorithm The algorithm to use for the search.
+ * @param[in] needles   The substrings to look for.
+ * @param[in] lengths   The lengths of the needles.
+ * @param[in] count     The number of needles.
+ *
+ * @returns Pointer to the compiled pattern set, which must
+ * be released using free_search_pattern_set(), or NULL if
+ * the needles are not suitable for the algorithm.
+ *
+ */
+search_pattern_set_t* compile_search_pattern_set_n(string_search_algorithm_t algorithm, const char* const* needles, const size_t* lengths, size_t count) {
+    search_pattern_set_t* set = allocate_pattern_set_memory(sizeof (search_pattern_set_t));
+
+    set->algorithm = algorithm;
+    set->count = count;
+    set->needles = allocate_pattern_set_memory(sizeof (const char*) * (count + 1));
+    set->lengths = allocate_pattern_set_memory(sizeof (size_t) * (count + 1));
+    set->table = NULL;
+    set->automaton = NULL;
+
+    /**
+     * The needles are copied into a single buffer, so the
+     * set remains valid even if the caller's copies of the
+     * needles do not.
+     *
+     */
+    size_t total = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        total += lengths[i] + 1;
+    }
+
+    set->buffer = allocate_pattern_set_memory(total + 1);
+
+    char* buffer = set->buffer;
+
+    for (size_t i = 0; i < count; ++i) {
+        memcpy(buffer, needles[i], lengths[i]);
+        buffer[lengths[i]] = '\0';
+
+        set->needles[i] = buffer;
+        set->lengths[i] = lengths[i];
+
+        buffer += lengths[i] + 1;
+    }
+
+    int status = 0;
+
+    switch (algorithm) {
+        case RABIN_KARP_STRING_SEARCH: {
+            status = build_rabin_karp_pattern_set(set);
+        } break;
+
+        default: {
+            /**
+             * The Aho-Corasick automaton is the generalization
+             * of every other single-needle algorithm to sets
+             * of needles, so they all use it.
+             *
+             */
+            set->algorithm = FINITE_AUTOMATON_STRING_SEARCH;
+            set->automaton = build_aho_corasick_automaton(set->needles, set->lengths, set->count);
+        } break;
+    }
+
+    if (status != 0) {
+        free_search_pattern_set(set);
+        return NULL;
+    }
+
+    return set;
+}
+
+/**
+ * Compile a set of search patterns.
+ *
+ * @param[in] algorithm The algorithm to use for the search.
+ * @param[in] needles   The substrings to look for.
+ * @param[in] count     The number of needles.
+ *
+ * @returns Pointer to the compiled pattern set, which must
+ * be released using free_search_pattern_set(), or NULL if
+ * the needles are not suitable for the algorithm.
+ *
+ */
+search_pattern_set_t* compile_search_pattern_set(string_search_algorithm_t algorithm, const char* const* needles, size_t count) {
+    size_t* lengths = allocate_pattern_set_memory(sizeof (size_t) * (count + 1));
+
+    for (size_t i = 0; i < count; ++i) {
+        lengths[i] = string_length(needles[i]);
+    }
+
+    search_pattern_set_t* set = compile_search_pattern_set_n(algorithm, needles, lengths, count);
+
+    free(lengths);
+
+    return set;
+}
+
+/**
+ * Report every match of a pattern set within a buffer.
+ *
+ * @param[in] set               The compiled pattern set.
+ * @param[in] haystack          The buffer to look in.
+ * @param[in] haystack_length   The length of the haystack.
+ * @param[in] callback          The function to report matches to.
+ * @param[in] context           User-supplied pointer passed to the callback.
+ *
+ * @returns The number of matches reported to the callback.
+ *
+ */
+size_t for_each_pattern_set_match_n(const search_pattern_set_t* set, const char* haystack, size_t haystack_length, pattern_set_match_callback_t callback, void* context) {
+    if (set->automaton != NULL) {
+        return run_aho_corasick_automaton(set->automaton, haystack, haystack_length, callback, context);
+    }
+
+    return rabin_karp_pattern_set_search(set, haystack, haystack_length, callback, context);
+}
+
+/**
+ * Report every match of a pattern set within a string.
+ *
+ * @param[in] set       The compiled pattern set.
+ * @param[in] haystack  The string to look in.
+ * @param[in] callback  The function to report matches to.
+ * @param[in] context   User-supplied pointer passed to the callback.
+ *
+ * @returns The number of matches reported to the callback.
+ *
+ */
+size_t for_each_pattern_set_match(const search_pattern_set_t* set, const char* haystack, pattern_set_match_callback_t callback, void* context) {
+    return for_each_pattern_set_match_n(set, haystack, string_length(haystack), callback, context);
+}
+
+/**
+ * Free a compiled pattern set.
+ *
+ * @param[in] set The pattern set to free. May be NULL.
+ *
+ */
+void free_search_pattern_set(search_pattern_set_t* set) {
+    if (set == NULL) {
+        return;
+    }
+
+    free(set->buffer);
+    free(set->needles);
+    free(set->lengths);
+    free(set->table);
+    free_aho_corasick_automaton(set->automaton);
+    free(set);
+}
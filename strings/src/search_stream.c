@@ -0,0 +1,187 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ * 
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ * 
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xstrings.h"
+
+/**
+ * Streaming Search Context
+ *
+ * The stream keeps a needle compiled for the
+ * Knuth-Morris-Pratt algorithm, together with the number of
+ * characters of the needle matched by the end of the last
+ * chunk. Since that count is exactly the state of the
+ * Knuth-Morris-Pratt matcher, the search resumes where it
+ * left off when the next chunk arrives.
+ *
+ * @struct search_stream
+ *
+ */
+struct search_stream {
+    /** The needle, compiled for Knuth-Morris-Pratt. */
+    search_pattern_t* pattern;
+
+    /** The number of needle characters currently matched. */
+    size_t state;
+
+    /** The number of haystack bytes consumed so far. */
+    size_t position;
+};
+
+/**
+ * Create a streaming search context for a length-delimited needle.
+ *
+ * @param[in] needle        The substring to look for.
+ * @param[in] needle_length The length of the needle.
+ *
+ * @returns Pointer to the search stream, which must be
+ * released using free_search_stream().
+ *
+ */
+search_stream_t* create_search_stream_n(const char* needle, size_t needle_length) {
+    search_stream_t* stream = malloc(sizeof (search_stream_t));
+
+    if (stream == NULL) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    stream->pattern = compile_search_pattern_n(KNUTH_MORRIS_PRATT_STRING_SEARCH, needle, needle_length);
+    stream->state = 0;
+    stream->position = 0;
+
+    return stream;
+}
+
+/**
+ * Create a streaming search context.
+ *
+ * @param[in] needle The substring to look for.
+ *
+ * @returns Pointer to the search stream, which must be
+ * released using free_search_stream().
+ *
+ */
+search_stream_t* create_search_stream(const char* needle) {
+    return create_search_stream_n(needle, string_length(needle));
+}
+
+/**
+ * Feed the next chunk of the haystack to a search stream.
+ *
+ * The callback is invoked once for every match completed
+ * within this chunk, with the offset of the start of the
+ * match relative to the beginning of the stream. Matches
+ * may overlap. If the callback asks for the search to stop,
+ * the rest of the chunk is left unconsumed, and it may be
+ * fed again later to resume the search.
+ *
+ * An empty needle never matches a stream.
+ *
+ * @param[in] stream        The search stream.
+ * @param[in] chunk         The next chunk of the haystack.
+ * @param[in] chunk_length  The length of the chunk.
+ * @param[in] callback      The function to report matches to.
+ * @param[in] context       User-supplied pointer passed to the callback.
+ *
+ * @returns The number of bytes of the chunk consumed.
+ *
+ * @cite cormen_introduction_2009
+ *
+ */
+size_t feed_search_stream(search_stream_t* stream, const char* chunk, size_t chunk_length, substring_match_callback_t callback, void* context) {
+    const char* needle = stream->pattern->needle;
+    const size_t* p = stream->pattern->prefix;
+    const size_t m = stream->pattern->length;
+
+    if (m == 0) {
+        stream->position += chunk_length;
+        return chunk_length;
+    }
+
+    size_t q = stream->state;
+
+    for (size_t i = 0; i < chunk_length; ++i) {
+        while ((q > 0) && (needle[q] != chunk[i])) {
+            q = p[q - 1];
+        }
+
+        if (needle[q] == chunk[i]) {
+            q = q + 1;
+        }
+
+        if (q == m) {
+            /**
+             * Fall back to the longest proper border of the
+             * needle, so that overlapping matches are found.
+             *
+             */
+            q = p[m - 1];
+
+            if (callback(stream->position + i + 1 - m, context) != 0) {
+                stream->state = q;
+                stream->position += i + 1;
+                return i + 1;
+            }
+        }
+    }
+
+    stream->state = q;
+    stream->position += chunk_length;
+
+    return chunk_length;
+}
+
+/**
+ * Reset a search stream to the start of a new haystack.
+ *
+ * @param[in] stream The search stream.
+ *
+ */
+void reset_search_stream(search_stream_t* stream) {
+    stream->state = 0;
+    stream->position = 0;
+}
+
+/**
+ * Free a search stream.
+ *
+ * @param[in] stream The search stream to free. May be NULL.
+ *
+ */
+void free_search_stream(search_stream_t* stream) {
+    if (stream == NULL) {
+        return;
+    }
+
+    free_search_pattern(stream->pattern);
+    free(stream);
+}
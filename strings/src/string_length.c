@@ -31,18 +31,34 @@
 
 #include "xstrings.h"
 
+#if defined(__x86_64__) && defined(__ELF__)
+#include <immintrin.h>
+
+/**
+ * This macro is defined when the vectorized implementations
+ * of string_length() are available, in which case the best
+ * one for the host processor is selected by the dynamic
+ * loader via an indirect function.
+ *
+ * @def XLIBS_STRING_LENGTH_IFUNC
+ *
+ */
+#define XLIBS_STRING_LENGTH_IFUNC
+#endif
+
 /**
  * Calculate the length of the given string.
  *
- * The function returns the length of the string pointed to
- * by <U>string</U>, excluding the null terminator.
+ * This is the portable, byte-at-a-time implementation of
+ * string_length(), used whenever no vectorized version is
+ * supported by the host.
  *
  * @param[in] string Pointer to null-terminated string.
  *
  * @returns Length of the given string, minus null terminator.
  *
  */
-size_t string_length(const char* string) {
+static size_t string_length_generic(const char* string) {
     size_t length = 0;
 
     while ((string[length] != '\0'))
@@ -50,3 +66,178 @@ size_t string_length(const char* string) {
     
     return length;
 }
+
+#ifdef XLIBS_STRING_LENGTH_IFUNC
+
+/**
+ * Calculate the length of the given string using SSE2.
+ *
+ * The vectorized implementations all follow the same
+ * strategy. The string pointer is first rounded down to the
+ * vector width, so that every load is aligned. An aligned
+ * load can never straddle a page boundary, so reading past
+ * the null terminator (or before the start of the string)
+ * within the same vector can never fault. The bits of the
+ * comparison mask corresponding to bytes before the start
+ * of the string are shifted out of the first mask.
+ *
+ * Those reads are left out of the address and thread
+ * sanitizers' instrumentation, which would report them as
+ * overflows or races, just as the C library's strlen,
+ * written in assembly, is.
+ *
+ * @param[in] string Pointer to null-terminated string.
+ *
+ * @returns Length of the given string, minus null terminator.
+ *
+ */
+__attribute__((target("sse2"), no_sanitize_address, no_sanitize_thread))
+size_t string_length_sse2(const char* string) {
+    const size_t offset = (uintptr_t) string & 15;
+    const __m128i* block = (const __m128i*) (string - offset);
+    const __m128i zero = _mm_setzero_si128();
+
+    uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero)) >> offset;
+
+    if (mask != 0) {
+        return __builtin_ctz(mask);
+    }
+
+    for (;;) {
+        mask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(++block), zero));
+
+        if (mask != 0) {
+            return (size_t) ((const char*) block - string) + __builtin_ctz(mask);
+        }
+    }
+}
+
+/**
+ * Calculate the length of the given string using AVX2.
+ *
+ * @param[in] string Pointer to null-terminated string.
+ *
+ * @returns Length of the given string, minus null terminator.
+ *
+ */
+__attribute__((target("avx2"), no_sanitize_address, no_sanitize_thread))
+size_t string_length_avx2(const char* string) {
+    const size_t offset = (uintptr_t) string & 31;
+    const __m256i* block = (const __m256i*) (string - offset);
+    const __m256i zero = _mm256_setzero_si256();
+
+    uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), zero)) >> offset;
+
+    if (mask != 0) {
+        return __builtin_ctz(mask);
+    }
+
+    for (;;) {
+        mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(++block), zero));
+
+        if (mask != 0) {
+            return (size_t) ((const char*) block - string) + __builtin_ctz(mask);
+        }
+    }
+}
+
+/**
+ * Calculate the length of the given string using AVX-512BW.
+ *
+ * @param[in] string Pointer to null-terminated string.
+ *
+ * @returns Length of the given string, minus null terminator.
+ *
+ */
+__attribute__((target("avx512f,avx512bw"), no_sanitize_address, no_sanitize_thread))
+size_t string_length_avx512bw(const char* string) {
+    const size_t offset = (uintptr_t) string & 63;
+    const __m512i* block = (const __m512i*) (string - offset);
+    const __m512i zero = _mm512_setzero_si512();
+
+    uint64_t mask = (uint64_t) _mm512_cmpeq_epi8_mask(_mm512_load_si512(block), zero) >> offset;
+
+    if (mask != 0) {
+        return __builtin_ctzll(mask);
+    }
+
+    for (;;) {
+        mask = (uint64_t) _mm512_cmpeq_epi8_mask(_mm512_load_si512(++block), zero);
+
+        if (mask != 0) {
+            return (size_t) ((const char*) block - string) + __builtin_ctzll(mask);
+        }
+    }
+}
+
+/**
+ * String Length Function
+ *
+ * @typedef string_length_function_t
+ *
+ */
+typedef size_t (*string_length_function_t)(const char*);
+
+/**
+ * Resolve String Length Function
+ *
+ * This function is run once by the dynamic loader when the
+ * string_length() symbol is first bound, and it returns the
+ * widest implementation supported by the host processor.
+ * It runs while the loader is still relocating the program,
+ * before the runtime of any sanitizer is initialized, so it
+ * must not be instrumented by any of them.
+ *
+ * @returns Function pointer to the string_length() implementation.
+ *
+ */
+__attribute__((no_sanitize_address, no_sanitize_thread, no_sanitize("undefined")))
+static string_length_function_t resolve_string_length(void) {
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512bw")) {
+        return string_length_avx512bw;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        return string_length_avx2;
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return string_length_sse2;
+    }
+
+    return string_length_generic;
+}
+
+/**
+ * Calculate the length of the given string.
+ *
+ * The function returns the length of the string pointed to
+ * by <U>string</U>, excluding the null terminator.
+ *
+ * @param[in] string Pointer to null-terminated string.
+ *
+ * @returns Length of the given string, minus null terminator.
+ *
+ */
+size_t string_length(const char* string) __attribute__((ifunc("resolve_string_length")));
+
+#else
+
+/**
+ * Calculate the length of the given string.
+ *
+ * The function returns the length of the string pointed to
+ * by <U>string</U>, excluding the null terminator.
+ *
+ * @param[in] string Pointer to null-terminated string.
+ *
+ * @returns Length of the given string, minus null terminator.
+ *
+ */
+size_t string_length(const char* string) {
+    return string_length_generic(string);
+}
+
+#endif /** XLIBS_STRING_LENGTH_IFUNC */
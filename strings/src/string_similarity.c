@@ -0,0 +1,368 @@
+/*
+ * xlibs - C Programming Language Extensions Libraries
+ * Copyright (C) 2020 Jose Fernando Lopez Fernandez
+ *
+ * This program is free software: you can redistribute it
+ * and/or modify it under the terms of the GNU General
+ * Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be
+ * useful, but WITHOUT ANY WARRANTY; without even the
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef XLIBS_INTERNAL
+#define XLIBS_INTERNAL
+#endif
+
+#include "xstrings.h"
+
+#ifndef MAX
+#define MAX(a,b) ((a < b) ? (b) : (a))
+#endif
+
+#ifndef MIN
+#define MIN(a,b) ((a > b) ? (b) : (a))
+#endif
+
+/**
+ * Jaro-Winkler Prefix Scale
+ *
+ * The weight given to each character of the common prefix
+ * of two strings by the Jaro-Winkler similarity.
+ *
+ * @def JARO_WINKLER_PREFIX_SCALE
+ *
+ */
+#ifndef JARO_WINKLER_PREFIX_SCALE
+#define JARO_WINKLER_PREFIX_SCALE 0.1
+#endif
+
+/**
+ * Jaro-Winkler Prefix Limit
+ *
+ * The longest common prefix rewarded by the Jaro-Winkler
+ * similarity. The product of the limit and the scale must
+ * not exceed 1.
+ *
+ * @def JARO_WINKLER_PREFIX_LIMIT
+ *
+ */
+#ifndef JARO_WINKLER_PREFIX_LIMIT
+#define JARO_WINKLER_PREFIX_LIMIT 4
+#endif
+
+/**
+ * Jaro-Winkler Boost Threshold
+ *
+ * The Jaro similarity above which the common prefix of two
+ * strings is rewarded, as in Winkler's original definition.
+ *
+ * @def JARO_WINKLER_BOOST_THRESHOLD
+ *
+ */
+#ifndef JARO_WINKLER_BOOST_THRESHOLD
+#define JARO_WINKLER_BOOST_THRESHOLD 0.7
+#endif
+
+/**
+ * Jaro Similarity From Matches
+ *
+ * @param[in] m The length of the first string.
+ * @param[in] n The length of the second string.
+ * @param[in] matches The number of matching characters.
+ * @param[in] transpositions The number of matched characters out of order.
+ *
+ * @returns The Jaro similarity of the two strings.
+ *
+ */
+static inline double jaro_similarity_from_matches(size_t m, size_t n, size_t matches, size_t transpositions) {
+    if (matches == 0) {
+        return 0.0;
+    }
+
+    const double c = (double) matches;
+
+    return ((c / (double) m) + (c / (double) n) + ((c - ((double) transpositions / 2.0)) / c)) / 3.0;
+}
+
+/**
+ * Jaro Similarity (Bitmask)
+ *
+ * This function computes the Jaro similarity of two strings
+ * of at most 64 characters without any allocation, and with
+ * a single data-dependent branch per character of a.
+ *
+ * The positions of every byte value in b are encoded as a
+ * bitmask, as for the bit-parallel Levenshtein algorithms,
+ * so the unmatched occurrences of a[i] in b within the
+ * matching window of position i are found by masking its
+ * bitmask with the window and with the complement of the
+ * positions of b already matched, the first of which is
+ * the lowest set bit. Only the entries of the bitmask
+ * table for bytes occurring in either string are ever
+ * read, so only those are cleared.
+ *
+ * The transpositions are then counted by walking the
+ * matched positions of both strings in step, taking the
+ * lowest set bit of each mask in turn.
+ *
+ * @param[in] a The first string to compare, of at most 64 characters.
+ * @param[in] m The length of a.
+ * @param[in] b The second string to compare, of at most 64 characters.
+ * @param[in] n The length of b.
+ *
+ * @returns The Jaro similarity of a and b.
+ *
+ */
+static double jaro_similarity_bitmask(const char* a, size_t m, const char* b, size_t n) {
+    uint64_t peq[256];
+
+    for (size_t i = 0; i < m; ++i) {
+        peq[(unsigned char) a[i]] = 0;
+    }
+
+    for (size_t j = 0; j < n; ++j) {
+        peq[(unsigned char) b[j]] = 0;
+    }
+
+    for (size_t j = 0; j < n; ++j) {
+        peq[(unsigned char) b[j]] |= (uint64_t) 1 << j;
+    }
+
+    const size_t window = (MAX(m, n) / 2 > 0) ? (MAX(m, n) / 2) - 1 : 0;
+
+    /** The mask of the positions of b, [0, n). */
+    const uint64_t positions = (n == 64) ? ~(uint64_t) 0 : (((uint64_t) 1 << n) - 1);
+
+    uint64_t a_matched = 0;
+    uint64_t b_matched = 0;
+    size_t matches = 0;
+
+    for (size_t i = 0; i < m; ++i) {
+        /** The window [i - window, i + window], clipped to b. */
+        const uint64_t above = (i + window >= 63) ? ~(uint64_t) 0 : (((uint64_t) 1 << (i + window + 1)) - 1);
+        const uint64_t below = (i > window) ? (((uint64_t) 1 << (i - window)) - 1) : 0;
+
+        const uint64_t candidates = peq[(unsigned char) a[i]] & ~b_matched & above & ~below & positions;
+
+        if (candidates != 0) {
+            b_matched |= candidates & (~candidates + 1);
+            a_matched |= (uint64_t) 1 << i;
+            ++matches;
+        }
+    }
+
+    size_t transpositions = 0;
+
+    while (a_matched != 0) {
+        const unsigned int i = (unsigned int) __builtin_ctzll(a_matched);
+        const unsigned int j = (unsigned int) __builtin_ctzll(b_matched);
+
+        transpositions += (a[i] != b[j]);
+
+        a_matched &= a_matched - 1;
+        b_matched &= b_matched - 1;
+    }
+
+    return jaro_similarity_from_matches(m, n, matches, transpositions);
+}
+
+/**
+ * Jaro Similarity (Generic)
+ *
+ * This function computes the Jaro similarity of strings of
+ * any length, keeping the matched positions of both in bit
+ * vectors allocated for the purpose.
+ *
+ * @param[in] a The first string to compare.
+ * @param[in] m The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] n The length of b.
+ *
+ * @returns The Jaro similarity of a and b.
+ *
+ */
+static double jaro_similarity_generic(const char* a, size_t m, const char* b, size_t n) {
+    uint64_t* a_matched = calloc((m + 63) / 64, sizeof (uint64_t));
+    uint64_t* b_matched = calloc((n + 63) / 64, sizeof (uint64_t));
+
+    if ((a_matched == NULL) || (b_matched == NULL)) {
+        fprintf(stderr, "[Error] %s\n", "Memory allocation failure");
+        exit(EXIT_FAILURE);
+    }
+
+    const size_t window = (MAX(m, n) / 2 > 0) ? (MAX(m, n) / 2) - 1 : 0;
+
+    size_t matches = 0;
+
+    for (size_t i = 0; i < m; ++i) {
+        const size_t low = (i > window) ? i - window : 0;
+        const size_t high = MIN(i + window + 1, n);
+
+        for (size_t j = low; j < high; ++j) {
+            const uint64_t bit = (uint64_t) 1 << (j % 64);
+
+            if (((b_matched[j / 64] & bit) == 0) && (a[i] == b[j])) {
+                b_matched[j / 64] |= bit;
+                a_matched[i / 64] |= (uint64_t) 1 << (i % 64);
+                ++matches;
+                break;
+            }
+        }
+    }
+
+    size_t transpositions = 0;
+    size_t j = 0;
+
+    for (size_t i = 0; i < m; ++i) {
+        if ((a_matched[i / 64] & ((uint64_t) 1 << (i % 64))) == 0) {
+            continue;
+        }
+
+        while ((b_matched[j / 64] & ((uint64_t) 1 << (j % 64))) == 0) {
+            ++j;
+        }
+
+        transpositions += (a[i] != b[j]);
+        ++j;
+    }
+
+    free(a_matched);
+    free(b_matched);
+
+    return jaro_similarity_from_matches(m, n, matches, transpositions);
+}
+
+/**
+ * Calculate the Jaro similarity between the strings
+ * represented by a and b.
+ *
+ * Two characters match if they are equal and no farther
+ * apart than half the length of the longer string, less
+ * one, each character matching at most once, in order. If
+ * c characters match, and t of them appear in a different
+ * order in either string, the similarity is the mean of
+ * c/m, c/n, and (c - t/2)/c. Two empty strings are
+ * identical.
+ *
+ * @param[in] a The first string to compare.
+ * @param[in] m The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] n The length of b.
+ *
+ * @returns The Jaro similarity of a and b, between 0 and 1.
+ *
+ * @cite jaro_advances_1989
+ *
+ */
+static double calculate_jaro_similarity(const char* a, size_t m, const char* b, size_t n) {
+    if ((m == 0) || (n == 0)) {
+        return ((m == 0) && (n == 0)) ? 1.0 : 0.0;
+    }
+
+    if ((m <= 64) && (n <= 64)) {
+        return jaro_similarity_bitmask(a, m, b, n);
+    }
+
+    return jaro_similarity_generic(a, m, b, n);
+}
+
+/**
+ * Calculate the Jaro-Winkler similarity between the
+ * strings represented by a and b.
+ *
+ * The Jaro-Winkler similarity rewards the strings whose
+ * Jaro similarity j exceeds the boost threshold for the
+ * length l of their common prefix, up to the prefix limit,
+ * as j + l p (1 - j), where p is the prefix scale.
+ *
+ * @param[in] a The first string to compare.
+ * @param[in] m The length of a.
+ * @param[in] b The second string to compare.
+ * @param[in] n The length of b.
+ *
+ * @returns The Jaro-Winkler similarity of a and b, between
+ * 0 and 1.
+ *
+ * @cite winkler_string_1990
+ *
+ */
+static double calculate_jaro_winkler_similarity(const char* a, size_t m, const char* b, size_t n) {
+    const double jaro = calculate_jaro_similarity(a, m, b, n);
+
+    if (jaro <= JARO_WINKLER_BOOST_THRESHOLD) {
+        return jaro;
+    }
+
+    const size_t limit = MIN(MIN(m, n), (size_t) JARO_WINKLER_PREFIX_LIMIT);
+
+    size_t prefix = 0;
+
+    while ((prefix < limit) && (a[prefix] == b[prefix])) {
+        ++prefix;
+    }
+
+    return jaro + ((double) prefix * JARO_WINKLER_PREFIX_SCALE * (1.0 - jaro));
+}
+
+/**
+ * Calculate the similarity of two given buffers.
+ *
+ * @param[in] string_similarity_type    The similarity metric to use.
+ * @param[in] a                         The first buffer to compare.
+ * @param[in] a_length                  The length of a.
+ * @param[in] b                         The second buffer to compare.
+ * @param[in] b_length                  The length of b.
+ *
+ * @returns The similarity of a and b, between 0 for
+ * entirely dissimilar buffers and 1 for identical ones.
+ *
+ */
+double calculate_string_similarity_n(string_similarity_type_t string_similarity_type, const char* a, size_t a_length, const char* b, size_t b_length) {
+    switch (string_similarity_type) {
+        case JARO_SIMILARITY: {
+            return calculate_jaro_similarity(a, a_length, b, b_length);
+        }
+
+        case JARO_WINKLER_SIMILARITY: {
+            return calculate_jaro_winkler_similarity(a, a_length, b, b_length);
+        }
+
+        default: {
+            fprintf(stderr, "[Error] %s\n", "Similarity metric not recognized.");
+        } break;
+    }
+
+    return 0.0;
+}
+
+/**
+ * Calculate the similarity of two given strings.
+ *
+ * @param[in] string_similarity_type    The similarity metric to use.
+ * @param[in] a                         The first string to compare.
+ * @param[in] b                         The second string to compare.
+ *
+ * @returns The similarity of a and b, between 0 for
+ * entirely dissimilar strings and 1 for identical ones.
+ *
+ */
+double calculate_string_similarity(string_similarity_type_t string_similarity_type, const char* a, const char* b) {
+    return calculate_string_similarity_n(string_similarity_type, a, string_length(a), b, string_length(b));
+}